@@ -11,13 +11,11 @@ case "$1" in
 		sleep 2
 		oat posicom mean FGRN FBLU POS -c config.toml -k combine 		& #> log.txt &
 		sleep 2
-		oat posifilt kalman PBLU FBLU -c config.toml -k kalman  		& #> log.txt &
+		oat posifilt kalman P_BLU FBLU -c config.toml -k kalman  		& #> log.txt &
 		sleep 2
-		oat posifilt kalman PGRN FGRN -c config.toml -k kalman  		& #> log.txt &
+		oat posifilt kalman P_GRN FGRN -c config.toml -k kalman  		& #> log.txt &
 		sleep 2
-		oat posidet hsv SUB PGRN -c config.toml -k hsv_green  			& #> log.txt &
-		sleep 2
-		oat posidet hsv SUB PBLU -c config.toml -k hsv_blue  			& #> log.txt &
+		oat posidet multihsv SUB P -c config.toml -k hsv_multi  		& #> log.txt &
 		sleep 2
 		oat framefilt mask RAW SUB -c config.toml -k mask  				& #> log.txt &
 		sleep 2
@@ -26,7 +24,7 @@ case "$1" in
 
 	clean)
 
-		oat clean RAW SUB PBLU PGRN POS FPOS FINAL
+		oat clean RAW SUB P_BLU P_GRN POS FPOS FINAL
 		;;
 
 	*)
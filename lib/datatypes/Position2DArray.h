@@ -0,0 +1,88 @@
+//******************************************************************************
+//* File:   Position2DArray.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef POSITION2DARRAY_H
+#define	POSITION2DARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Position2D.h"
+
+namespace oat {
+
+    /**
+     * Fixed capacity array of 2D positions, e.g. the positions of several
+     * objects detected in one frame. Positions are stored inline so that the
+     * whole array is published in a single shared memory slot.
+     */
+    class Position2DArray {
+
+    public:
+
+        static constexpr size_t CAPACITY {16};
+
+        size_t size(void) const { return count; }
+        bool empty(void) const { return count == 0; }
+        bool full(void) const { return count == CAPACITY; }
+        void clear(void) { count = 0; }
+
+        /**
+         * Append a position.
+         * @param position Position to append.
+         * @return False if the array is full and the position was not added.
+         */
+        bool push_back(const Position2D& position) {
+            if (full())
+                return false;
+            positions[count++] = position;
+            return true;
+        }
+
+        Position2D& operator[](const size_t i) { return positions[i]; }
+        const Position2D& operator[](const size_t i) const { return positions[i]; }
+
+        Position2D* begin(void) { return positions; }
+        Position2D* end(void) { return positions + count; }
+        const Position2D* begin(void) const { return positions; }
+        const Position2D* end(void) const { return positions + count; }
+
+        inline void set_sample(const uint32_t value) {
+            for (auto& p : *this)
+                p.set_sample(value);
+        }
+
+        template <typename Writer>
+        void Serialize(Writer& writer) const {
+
+            writer.StartArray();
+            for (const auto& p : *this)
+                p.Serialize(writer);
+            writer.EndArray(count);
+        }
+
+    private:
+
+        uint32_t count {0};
+        Position2D positions[CAPACITY];
+    };
+} // namespace oat
+
+#endif	/* POSITION2DARRAY_H */
@@ -31,6 +31,7 @@ namespace oat {
     BufferedMatServer::BufferedMatServer(const std::string& sink_name) :
       name(sink_name)
     , serve_thread_running(true)
+    , blocking(false)
     , shmem_name(sink_name + "_sh_mem")
     , shobj_name(sink_name + "_sh_obj")
     , shmgr_name(sink_name + "_sh_mgr")
@@ -114,6 +115,15 @@ namespace oat {
      */
     void BufferedMatServer::pushMat(const cv::Mat& mat, const uint32_t& sample_number) {
 
+        // Wait for the server thread to free a slot rather than dropping the
+        // sample
+        if (blocking) {
+            std::unique_lock<std::mutex> lk(space_mutex);
+            while (serve_thread_running && mat_buffer.write_available() == 0) {
+                space_condition.wait_for(lk, std::chrono::milliseconds(10));
+            }
+        }
+
         // Push data onto ring buffer
         mat_buffer.push(std::make_pair(sample_number, mat.clone()));
 
@@ -121,6 +131,15 @@ namespace oat {
         serve_condition.notify_one();
     }
 
+    void BufferedMatServer::flush() {
+
+        std::unique_lock<std::mutex> lk(space_mutex);
+        while (serve_thread_running && mat_buffer.read_available() > 0) {
+            serve_condition.notify_one();
+            space_condition.wait_for(lk, std::chrono::milliseconds(10));
+        }
+    }
+
     void BufferedMatServer::serveMatFromBuffer() {
 
         while (serve_thread_running) {
@@ -137,6 +156,9 @@ namespace oat {
             
             while (mat_buffer.pop(sample)) {
 
+                // A slot has been freed for blocked producers
+                space_condition.notify_one();
+
 #ifndef NDEBUG
 
                 std::cout << oat::dbgMessage("[");
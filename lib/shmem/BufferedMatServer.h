@@ -41,11 +41,25 @@ namespace oat {
 
         void pushMat(const cv::Mat& mat, const uint32_t& sample_number);
         void setSharedServerState(oat::ServerRunState state);
+
+        /**
+         * Block until all buffered samples have been published to shared
+         * memory or the server thread has been stopped.
+         */
+        void flush(void);
         
         // Accessors 
         std::string get_name(void) const { return name; }
         void set_running(bool value) {serve_thread_running = value; }
 
+        /**
+         * In blocking mode, pushMat() waits for buffer space instead of
+         * dropping samples when the buffer is full. This propagates
+         * backpressure from the slowest client to the caller.
+         * @param value true to block on a full buffer.
+         */
+        void set_blocking(bool value) { blocking = value; }
+
     private:
 
         // Name of this server
@@ -61,6 +75,9 @@ namespace oat {
         std::mutex server_mutex;
         std::atomic<bool> serve_thread_running;
         std::condition_variable serve_condition;
+        std::mutex space_mutex;
+        std::condition_variable space_condition;
+        std::atomic<bool> blocking;
         oat::SharedCVMatHeader* shared_mat_header;
         oat::SharedMemoryManager* shared_mem_manager;
         bool shared_object_created;
@@ -29,14 +29,15 @@ namespace oat {
 
     namespace bip = boost::interprocess;
 
-    MatClient::MatClient(const std::string source_name) :
+    MatClient::MatClient(const std::string source_name, const bool incremental) :
       name(source_name)
     , shmem_name(source_name + "_sh_mem")
     , shobj_name(source_name + "_sh_obj")
     , shsig_name(source_name + "_sh_mgr")
     , shared_object_found(false)
     , mat_attached_to_header(false)
-    , read_barrier_passed(false) {
+    , read_barrier_passed(false)
+    , incremental(incremental) {
 
         findSharedMat();
     }
@@ -85,7 +86,9 @@ namespace oat {
 
     /**
      * Get the cv::Mat object from shared memory
-     * @param value The cv::Mat object to be copied from shared memory
+     * @param value The cv::Mat object to be copied from shared memory. In
+     * incremental mode, this is only valid until the next call and must not
+     * be modified.
      * @return True if the result is (1) valid and (2) successfully obeyed all 
      * interprocess synchronization mechanisms. False if there were timeouts during
      * wait() calls, meaning that the cv::Mat objects has possibly not been assigned
@@ -119,8 +122,25 @@ namespace oat {
                 }
 
                 // Assign the latest cv::Mat and get its timestamp and write index
-                value = shared_cvmat.clone(); 
+                if (incremental) {
+
+                    // Full copy unless the mirror holds the previous sample
+                    uint64_t write_count = shared_mat_header->get_write_count();
+                    if (mirror.empty() || write_count != mirror_write_count + 1)
+                        shared_cvmat.copyTo(mirror);
+                    else
+                        shared_mat_header->readDirtyTiles(shared_memory, mirror);
+
+                    mirror_write_count = write_count;
+                    value = mirror;
+
+                } else {
+                    value = shared_cvmat.clone(); 
+                }
                 current_sample_number = shared_mat_header->get_sample_number();
+                current_offset = shared_mat_header->get_offset();
+                current_scale = shared_mat_header->get_scale();
+                current_packed_width = shared_mat_header->get_packed_width();
 
                 // Now that this client has finished its read, update the count
                 shared_mat_header->client_read_count++;
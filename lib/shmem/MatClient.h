@@ -31,7 +31,7 @@ namespace oat {
     class MatClient {
     public:
         //MatClient(void);
-        MatClient(const std::string server_name);
+        MatClient(const std::string server_name, const bool incremental = false);
         virtual ~MatClient();
 
         // get cv::Mat out of shared memory
@@ -45,6 +45,14 @@ namespace oat {
         // TODO: bool is_shared_object_found(void) const { return shared_object_found; }
         uint32_t get_current_sample_number(void) const { return current_sample_number; }
 
+        // Mapping from current frame to full frame pixel coordinates:
+        //   full = offset + scale * frame
+        cv::Point2d get_current_offset(void) const { return current_offset; }
+        double get_current_scale(void) const { return current_scale; }
+
+        // Width in pixels if the current frame is a bit packed mask, else 0
+        int get_current_packed_width(void) const { return current_packed_width; }
+
     private:
 
         std::string name;
@@ -56,6 +64,13 @@ namespace oat {
 
         // Shared mat object, constructed from the shared_mat_header
         cv::Mat shared_cvmat;
+
+        // In incremental mode, getSharedMat() returns a private copy of the
+        // shared mat that is updated with only the tiles that changed since
+        // the previous sample. The caller must not modify it.
+        const bool incremental;
+        cv::Mat mirror;
+        uint64_t mirror_write_count {0};
         const std::string shmem_name, shobj_name, shsig_name;
         boost::interprocess::managed_shared_memory shared_memory;
 
@@ -65,6 +80,9 @@ namespace oat {
 
         // Time keeping
         uint32_t current_sample_number;
+        cv::Point2d current_offset;
+        double current_scale {1.0};
+        int current_packed_width {0};
 
         // Find cv::Mat object in shared memory
         int findSharedMat(void);
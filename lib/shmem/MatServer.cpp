@@ -96,8 +96,14 @@ namespace oat {
      * Push a deep copy of cv::Mat object to shared memory along with sample number.
      * @param mat cv::Mat to push to shared memory
      * @param sample_number sample number of cv::Mat
+     * @param offset position of the cv::Mat origin within the full frame
+     * @param scale size of cv::Mat pixels in full frame pixels
+     * @param packed_width width in pixels if cv::Mat is a bit packed mask, 
+     * otherwise 0
      */
-    void MatServer::pushMat(const cv::Mat& mat, const uint32_t& sample_number) {
+    void MatServer::pushMat(const cv::Mat& mat, const uint32_t& sample_number, 
+                            const cv::Point2d& offset, const double scale,
+                            const int packed_width) {
 
 #ifndef NDEBUG
 
@@ -120,7 +126,7 @@ namespace oat {
             shared_mat_header->mutex.wait();
 
             // Perform writes in shared memory 
-            shared_mat_header->writeSample(sample_number, mat);
+            shared_mat_header->writeSample(sample_number, mat, offset, scale, packed_width);
 
             // Tell each client they can proceed
             for (int i = 0; i < shared_mem_manager->get_client_ref_count(); ++i) {
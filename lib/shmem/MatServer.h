@@ -35,7 +35,10 @@ namespace oat {
         virtual ~MatServer();
 
         void createSharedMat(void);
-        void pushMat(const cv::Mat& mat, const uint32_t& sample_number);
+        void pushMat(const cv::Mat& mat, const uint32_t& sample_number, 
+                     const cv::Point2d& offset = cv::Point2d(0, 0),
+                     const double scale = 1.0,
+                     const int packed_width = 0);
         void setSharedServerState(oat::ServerRunState state);
       
         // Accessors 
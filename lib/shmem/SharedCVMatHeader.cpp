@@ -17,6 +17,7 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //****************************************************************************
 
+#include <algorithm>
 #include <cstring>
 #include <opencv2/core/mat.hpp>
 
@@ -29,12 +30,41 @@ namespace oat {
     , write_barrier(0)
     , read_barrier(0)
     , new_data_barrier(0)
-    , sample_number(0) { }
+    , sample_number(0)
+    , scale(1.0)
+    , packed_width(0)
+    , write_count(0)
+    , num_tiles(0) { }
 
-    void SharedCVMatHeader::writeSample(const uint32_t sample, const cv::Mat& value) {
-        
-        std::memcpy(data_ptr, value.data, data_size_in_bytes);
+    void SharedCVMatHeader::writeSample(const uint32_t sample, const cv::Mat& value, 
+                                        const cv::Point2d& origin,
+                                        const double pixel_scale,
+                                        const int mask_width) {
+
+        const uint8_t* src = value.data;
+        uint8_t* dst = static_cast<uint8_t*>(data_ptr);
+
+        // Masked and background subtracted streams are mostly unchanged
+        // between samples. Comparing a tile fails fast if it has changed, so
+        // this costs little more than a plain copy when everything changes.
+        for (size_t t = 0; t < num_tiles; t++) {
+
+            const size_t begin = t * TILE_BYTES;
+            const size_t n = std::min(TILE_BYTES, data_size_in_bytes - begin);
+
+            const bool dirty = write_count == 0 || 
+                               std::memcmp(dst + begin, src + begin, n) != 0;
+            if (dirty)
+                std::memcpy(dst + begin, src + begin, n);
+
+            dirty_ptr[t] = dirty;
+        }
+
+        write_count++;
         sample_number = sample;
+        offset = origin;
+        scale = pixel_scale;
+        packed_width = mask_width;
     }
     
     void SharedCVMatHeader::buildHeader(boost::interprocess::managed_shared_memory& shared_mem, const cv::Mat& model) {
@@ -44,6 +74,10 @@ namespace oat {
         mat_size = model.size();
         type = model.type();
         handle = shared_mem.get_handle_from_address(data_ptr);
+
+        num_tiles = (data_size_in_bytes + TILE_BYTES - 1) / TILE_BYTES;
+        dirty_ptr = static_cast<uint8_t*>(shared_mem.allocate(num_tiles));
+        dirty_handle = shared_mem.get_handle_from_address(dirty_ptr);
     }
 
     void SharedCVMatHeader::attachMatToHeader(boost::interprocess::managed_shared_memory& shared_mem, cv::Mat& mat) {
@@ -52,4 +86,22 @@ namespace oat {
         mat.data = static_cast<uchar*> (shared_mem.get_address_from_handle(handle));
     }
 
+    void SharedCVMatHeader::readDirtyTiles(boost::interprocess::managed_shared_memory& shared_mem, cv::Mat& mat) const {
+
+        // mat must be a continuous copy of the previous sample
+        const uint8_t* src = static_cast<const uint8_t*>(shared_mem.get_address_from_handle(handle));
+        const uint8_t* dirty = static_cast<const uint8_t*>(shared_mem.get_address_from_handle(dirty_handle));
+        uint8_t* dst = mat.data;
+
+        for (size_t t = 0; t < num_tiles; t++) {
+
+            if (!dirty[t])
+                continue;
+
+            const size_t begin = t * TILE_BYTES;
+            std::memcpy(dst + begin, src + begin, 
+                        std::min(TILE_BYTES, data_size_in_bytes - begin));
+        }
+    }
+
 } // namespace oat
@@ -40,10 +40,23 @@ namespace oat {
 
         void buildHeader(boost::interprocess::managed_shared_memory& shared_mem, const cv::Mat& model);
         void attachMatToHeader(boost::interprocess::managed_shared_memory& shared_mem, cv::Mat& mat);
-        void writeSample(const uint32_t sample, const cv::Mat& value); // Server
+        void readDirtyTiles(boost::interprocess::managed_shared_memory& shared_mem, cv::Mat& mat) const; // Client
+        void writeSample(const uint32_t sample, const cv::Mat& value, 
+                         const cv::Point2d& offset = cv::Point2d(0, 0),
+                         const double scale = 1.0,
+                         const int packed_width = 0); // Server
         
         // Accessors
         uint32_t get_sample_number(void) const {return sample_number; }
+        cv::Point2d get_offset(void) const {return offset; }
+        double get_scale(void) const {return scale; }
+        int get_packed_width(void) const {return packed_width; }
+        uint64_t get_write_count(void) const {return write_count; }
+
+        // Matrix data is tracked in tiles of this many bytes. Only tiles that
+        // differ from the previous sample are written, and clients can read
+        // only those tiles.
+        static const size_t TILE_BYTES {4096};
 		
     private:
 
@@ -51,11 +64,29 @@ namespace oat {
         cv::Size mat_size;
         int type;
         void* data_ptr;
-        int data_size_in_bytes;
+        size_t data_size_in_bytes;
         
         // Sample number
         // Should respect buffer overruns
         uint32_t sample_number;
+
+        // Mapping from matrix to full frame pixel coordinates:
+        //   full = offset + scale * matrix
+        // offset is non-zero if the frame has been cropped upstream and scale
+        // is greater than 1 if it has been downsampled.
+        cv::Point2d offset;
+        double scale;
+
+        // Width in pixels of a bit packed binary mask (see PackedMask.h). 0
+        // if the matrix is not packed.
+        int packed_width;
+
+        // Number of samples written, and which tiles changed in the most
+        // recent one (one byte per tile)
+        uint64_t write_count;
+        size_t num_tiles;
+        uint8_t* dirty_ptr;
+        boost::interprocess::managed_shared_memory::handle_t dirty_handle;
         
         boost::interprocess::managed_shared_memory::handle_t handle;
         
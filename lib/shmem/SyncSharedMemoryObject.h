@@ -25,6 +25,7 @@
 
 #include "../datatypes/Position.h"
 #include "../datatypes/Position2D.h"
+#include "../datatypes/Position2DArray.h"
 
 namespace oat {
 
@@ -77,6 +78,7 @@ namespace oat {
 
 // Explicit declaration
 template class oat::SyncSharedMemoryObject<oat::Position2D>;
+template class oat::SyncSharedMemoryObject<oat::Position2DArray>;
 
 #endif	/* SYNCSHAREDMEMORYOBJECT_H */
 
@@ -0,0 +1,159 @@
+//******************************************************************************
+//* File:   ColorLUT.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef COLORLUT_H
+#define COLORLUT_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace oat {
+
+    /**
+     * HSV pass band for color classification. Bounds are inclusive, as for
+     * cv::inRange.
+     */
+    struct HSVRange {
+        int h_min, h_max;
+        int s_min, s_max;
+        int v_min, v_max;
+
+        bool operator==(const HSVRange& o) const {
+            return h_min == o.h_min && h_max == o.h_max &&
+                   s_min == o.s_min && s_max == o.s_max &&
+                   v_min == o.v_min && v_max == o.v_max;
+        }
+    };
+
+    /**
+     * BGR to color class lookup table. Each entry holds one bit per HSV
+     * range that its color falls in, so up to 8 ranges can be tested with a
+     * single table read per pixel and no per-frame color conversion.
+     *
+     * The table is indexed by BGR values quantized to a number of bits per
+     * channel: 8 bits gives a 16 MB table that classifies exactly as
+     * cvtColor(COLOR_BGR2HSV) followed by inRange would; 5 or 6 bits gives a
+     * table that fits in L1 or L2 cache, classifying by the center of each
+     * quantization bin.
+     */
+    class ColorLUT {
+    public:
+
+        static const size_t MAX_RANGES {8};
+
+        /**
+         * Build the table. Only rebuilt if the ranges or quantization have
+         * changed since the last call.
+         * @param ranges HSV ranges. Range k sets bit k of matching entries.
+         * @param bits Bits per channel (1-8).
+         */
+        void build(const std::vector<HSVRange>& ranges, const int bits) {
+
+            CV_Assert(ranges.size() <= MAX_RANGES && bits >= 1 && bits <= 8);
+
+            if (bits == bits_ && ranges == ranges_)
+                return;
+
+            // Color at the center of each bin, in index order (b, g, r)
+            const int levels = 1 << bits;
+            const int shift = 8 - bits;
+            const int half = shift > 0 ? 1 << (shift - 1) : 0;
+
+            cv::Mat bgr(levels * levels, levels, CV_8UC3);
+            for (int b = 0; b < levels; b++) {
+                for (int g = 0; g < levels; g++) {
+                    uint8_t* row = bgr.ptr<uint8_t>(b * levels + g);
+                    for (int r = 0; r < levels; r++, row += 3) {
+                        row[0] = (b << shift) + half;
+                        row[1] = (g << shift) + half;
+                        row[2] = (r << shift) + half;
+                    }
+                }
+            }
+
+            cv::Mat hsv, in_range;
+            cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
+
+            table_.assign(bgr.total(), 0);
+            for (size_t k = 0; k < ranges.size(); k++) {
+
+                const HSVRange& rg = ranges[k];
+                cv::inRange(hsv, cv::Scalar(rg.h_min, rg.s_min, rg.v_min), 
+                                 cv::Scalar(rg.h_max, rg.s_max, rg.v_max), in_range);
+
+                const uint8_t* m = in_range.ptr<uint8_t>(0);
+                for (size_t i = 0; i < table_.size(); i++)
+                    table_[i] |= (m[i] != 0) << k;
+            }
+
+            ranges_ = ranges;
+            bits_ = bits;
+        }
+
+        /**
+         * Classify each pixel of a BGR frame in a single pass.
+         * @param bgr CV_8UC3 frame.
+         * @param classes CV_8UC1 class bits of each pixel.
+         */
+        void apply(const cv::Mat& bgr, cv::Mat& classes) const {
+
+            CV_Assert(bgr.type() == CV_8UC3 && bits_ > 0);
+
+            classes.create(bgr.size(), CV_8UC1);
+
+            const int shift = 8 - bits_;
+            const int bits = bits_;
+            const uint8_t* table = table_.data();
+
+            int rows = bgr.rows;
+            int cols = bgr.cols;
+            if (bgr.isContinuous() && classes.isContinuous()) {
+                cols *= rows;
+                rows = 1;
+            }
+
+            for (int i = 0; i < rows; i++) {
+
+                const uint8_t* p = bgr.ptr<uint8_t>(i);
+                uint8_t* c = classes.ptr<uint8_t>(i);
+
+                for (int j = 0; j < cols; j++, p += 3) {
+                    const uint32_t index = 
+                          (static_cast<uint32_t>(p[0] >> shift) << (2 * bits)) 
+                        | (static_cast<uint32_t>(p[1] >> shift) << bits) 
+                        | (p[2] >> shift);
+                    c[j] = table[index];
+                }
+            }
+        }
+
+        bool empty(void) const { return bits_ == 0; }
+
+    private:
+
+        std::vector<HSVRange> ranges_;
+        int bits_ {0};
+        std::vector<uint8_t> table_;
+    };
+
+} // namespace oat
+
+#endif // COLORLUT_H
@@ -0,0 +1,210 @@
+//******************************************************************************
+//* File:   OrderedWorkerPool.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef ORDEREDWORKERPOOL_H
+#define ORDEREDWORKERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace oat {
+
+    /**
+     * Processes a stream of inputs on a fixed set of worker threads and
+     * returns the results in input order. Input n is always given to worker
+     * n mod K, so each worker sees every K-th input and can keep state, such
+     * as its own copy of a filter, between inputs. At most K inputs are in
+     * flight, which bounds the added latency to K inputs.
+     */
+    template <typename In, typename Out>
+    class OrderedWorkerPool {
+    public:
+
+        /**
+         * Function run by each worker. Called with the worker's index and
+         * the input.
+         */
+        using Job = std::function<Out(const size_t worker, In& input)>;
+
+        /**
+         * Start the worker threads.
+         * @param num_workers Number of workers (K).
+         * @param job Function applied to each input.
+         */
+        OrderedWorkerPool(const size_t num_workers, Job job) :
+          job(job)
+        , slots(num_workers) {
+
+            if (num_workers == 0)
+                throw (std::runtime_error("A worker pool needs at least one worker."));
+
+            for (size_t i = 0; i < num_workers; i++)
+                threads.emplace_back(&OrderedWorkerPool::work, this, i);
+        }
+
+        ~OrderedWorkerPool() {
+
+            for (auto& s : slots) {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.stop = true;
+                s.cv.notify_all();
+            }
+
+            for (auto& t : threads)
+                t.join();
+        }
+
+        OrderedWorkerPool(const OrderedWorkerPool&) = delete;
+        OrderedWorkerPool& operator=(const OrderedWorkerPool&) = delete;
+
+        size_t num_workers(void) const { return slots.size(); }
+
+        /**
+         * @return Number of inputs whose results have not been collected.
+         */
+        size_t in_flight(void) const { return next_in - next_out; }
+
+        bool full(void) const { return in_flight() == slots.size(); }
+
+        /**
+         * Give the next input to its worker. The pool must not be full.
+         * @param input Input, moved to the worker.
+         */
+        void push(In input) {
+
+            if (full())
+                throw (std::runtime_error("Worker pool is full."));
+
+            Slot& s = slots[next_in++ % slots.size()];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.input = std::move(input);
+            s.state = State::QUEUED;
+            s.cv.notify_all();
+        }
+
+        /**
+         * Wait for the result of the oldest input in flight.
+         * @return Result. Exceptions thrown by the job are rethrown here.
+         */
+        Out pop(void) {
+
+            if (in_flight() == 0)
+                throw (std::runtime_error("Worker pool is empty."));
+
+            Slot& s = slots[next_out % slots.size()];
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.cv.wait(lock, [&s] { return s.state == State::DONE; });
+
+            return collect(s);
+        }
+
+        /**
+         * Get the result of the oldest input in flight, if it is ready.
+         * @param result Result, if ready.
+         * @return True if a result was ready.
+         */
+        bool tryPop(Out& result) {
+
+            if (in_flight() == 0)
+                return false;
+
+            Slot& s = slots[next_out % slots.size()];
+            std::unique_lock<std::mutex> lock(s.mutex);
+            if (s.state != State::DONE)
+                return false;
+
+            result = collect(s);
+            return true;
+        }
+
+    private:
+
+        enum class State { IDLE, QUEUED, DONE };
+
+        struct Slot {
+            std::mutex mutex;
+            std::condition_variable cv;
+            State state {State::IDLE};
+            bool stop {false};
+            In input;
+            Out output;
+            std::exception_ptr error;
+        };
+
+        Job job;
+        std::vector<Slot> slots;
+        std::vector<std::thread> threads;
+
+        // Only used by the thread that calls push() and pop()
+        size_t next_in {0};
+        size_t next_out {0};
+
+        // Called with the slot's mutex held
+        Out collect(Slot& s) {
+
+            next_out++;
+            s.state = State::IDLE;
+
+            if (s.error) {
+                std::exception_ptr e = s.error;
+                s.error = nullptr;
+                std::rethrow_exception(e);
+            }
+
+            return std::move(s.output);
+        }
+
+        void work(const size_t index) {
+
+            Slot& s = slots[index];
+            std::unique_lock<std::mutex> lock(s.mutex);
+
+            while (true) {
+
+                s.cv.wait(lock, [&s] { return s.stop || s.state == State::QUEUED; });
+                if (s.stop)
+                    return;
+
+                // The slot is not touched by the caller until the result is
+                // marked DONE, so the job runs without holding the lock
+                lock.unlock();
+                try {
+                    s.output = job(index, s.input);
+                } catch (...) {
+                    s.error = std::current_exception();
+                }
+                lock.lock();
+
+                s.state = State::DONE;
+                s.cv.notify_all();
+            }
+        }
+    };
+
+} // namespace oat
+
+#endif // ORDEREDWORKERPOOL_H
@@ -0,0 +1,207 @@
+//******************************************************************************
+//* File:   Pacer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef PACER_H
+#define PACER_H
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <sstream>
+#include <string>
+
+namespace oat {
+
+    /**
+     * Paces a periodic process using absolute deadlines. Sample n is released
+     * at start + n * period, where start is the time of the first call to
+     * wait(). Because deadlines do not depend on when the previous wait()
+     * returned, scheduling error does not accumulate and the long term rate
+     * equals the nominal rate.
+     */
+    class Pacer {
+    public:
+
+        /**
+         * What to do when a deadline has already passed by more than one
+         * period when wait() is called.
+         */
+        enum class LatePolicy {
+            CATCH_UP, //!< Release immediately until back on schedule. Every
+                      //!< period is served, so the average rate is exact.
+            SKIP      //!< Move to the next deadline that is in the future.
+                      //!< Missed periods are reported by wait().
+        };
+
+        explicit Pacer(const double rate_hz = 30.0,
+                       const LatePolicy policy = LatePolicy::CATCH_UP) :
+          policy(policy)
+        , started(false)
+        , start_ns(0)
+        , period_index(0) {
+
+            set_rate(rate_hz);
+            resetStatistics();
+        }
+
+        /**
+         * Change the rate. The schedule is re-anchored at the most recent
+         * deadline so that the change does not cause a jump.
+         * @param rate_hz Rate in Hz.
+         */
+        void set_rate(const double rate_hz) {
+
+            if (started) {
+                start_ns = deadline();
+                period_index = 0;
+            }
+
+            period_ns = 1e9 / rate_hz;
+        }
+
+        void set_policy(const LatePolicy value) { policy = value; }
+
+        double get_period(void) const { return period_ns * 1e-9; }
+
+        /**
+         * Restart the schedule. The next call to wait() returns immediately
+         * and becomes the new start time.
+         */
+        void reset(void) {
+            started = false;
+            period_index = 0;
+        }
+
+        /**
+         * Block until the deadline of the current period and advance to the
+         * next.
+         * @return Number of periods skipped because their deadlines had
+         * already passed. Always 0 if the policy is CATCH_UP.
+         */
+        uint64_t wait(void) {
+
+            if (!started) {
+                start_ns = now();
+                period_index = 1;
+                started = true;
+                return 0;
+            }
+
+            int64_t target = deadline();
+            int64_t current = now();
+            uint64_t skipped = 0;
+
+            if (current < target) {
+
+                struct timespec ts;
+                ts.tv_sec = target / 1000000000;
+                ts.tv_nsec = target % 1000000000;
+
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) { }
+
+                current = now();
+
+            } else if (policy == LatePolicy::SKIP && current - target >= period_ns) {
+
+                skipped = static_cast<uint64_t>((current - target) / period_ns);
+                period_index += skipped;
+                missed += skipped;
+            }
+
+            recordLateness(current - deadline());
+            period_index++;
+
+            return skipped;
+        }
+
+        // Lateness statistics. Lateness is the time between a deadline and
+        // the release of the corresponding sample (seconds).
+        uint64_t get_count(void) const { return count; }
+        uint64_t get_missed(void) const { return missed; }
+        double get_mean_lateness(void) const { return mean * 1e-9; }
+        double get_max_lateness(void) const { return max * 1e-9; }
+        double get_jitter(void) const {
+            return count > 1 ? std::sqrt(m2 / (count - 1)) * 1e-9 : 0.0;
+        }
+
+        std::string report(void) const {
+
+            std::stringstream ss;
+            ss.precision(3);
+            ss << std::fixed << count << " samples at " << 1e9 / period_ns
+               << " Hz, lateness mean " << get_mean_lateness() * 1e3
+               << " ms, max " << get_max_lateness() * 1e3
+               << " ms, jitter " << get_jitter() * 1e3
+               << " ms, " << missed << " periods skipped.";
+            return ss.str();
+        }
+
+        void resetStatistics(void) {
+            count = 0;
+            missed = 0;
+            mean = 0.0;
+            m2 = 0.0;
+            max = 0.0;
+        }
+
+    private:
+
+        LatePolicy policy;
+        double period_ns;
+
+        // Schedule
+        bool started;
+        int64_t start_ns;
+        uint64_t period_index;
+
+        // Statistics (nanoseconds)
+        uint64_t count;
+        uint64_t missed;
+        double mean, m2, max;
+
+        int64_t deadline(void) const {
+
+            // Computed from the start time, rather than accumulated, so that
+            // rounding the period to nanoseconds does not cause drift
+            return start_ns + std::llround(period_index * period_ns);
+        }
+
+        static int64_t now(void) {
+
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        }
+
+        void recordLateness(const double lateness_ns) {
+
+            // Welford's method
+            count++;
+            double delta = lateness_ns - mean;
+            mean += delta / count;
+            m2 += delta * (lateness_ns - mean);
+            if (lateness_ns > max)
+                max = lateness_ns;
+        }
+    };
+
+} // namespace oat
+
+#endif // PACER_H
@@ -0,0 +1,209 @@
+//******************************************************************************
+//* File:   PackedMask.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef PACKEDMASK_H
+#define PACKEDMASK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace oat {
+
+    /**
+     * Binary masks packed at one bit per pixel.
+     *
+     * A packed mask is a CV_8UC1 matrix with one row per frame row. Each row
+     * holds ceil(width / 64) 64-bit words, so rows can be processed a word at
+     * a time. Pixel j of a row is bit (j % 64) of word (j / 64), least
+     * significant bit first. Bits past the frame width are 0. The frame width
+     * travels with the mask in the shared frame header.
+     */
+    namespace packed {
+
+        inline int wordsPerRow(const int width) { return (width + 63) / 64; }
+
+        /**
+         * Set one bit per pixel for pixels greater than a threshold.
+         * @param src Row of 8-bit pixel values.
+         * @param width Number of pixels.
+         * @param threshold Pixels greater than this are set.
+         * @param dst Packed row of wordsPerRow(width) words.
+         */
+        inline void packRow(const uint8_t* src, const int width,
+                            const uint8_t threshold, uint64_t* dst) {
+
+            std::memset(dst, 0, wordsPerRow(width) * sizeof(uint64_t));
+
+            int j = 0;
+#ifdef __SSE2__
+            // SSE2 only has a signed byte compare, so shift both sides into
+            // signed range. movemask then packs the 16 results into 16 bits.
+            const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+            const __m128i t = _mm_xor_si128(
+                    _mm_set1_epi8(static_cast<char>(threshold)), bias);
+            for (; j + 16 <= width; j += 16) {
+                __m128i v = _mm_xor_si128(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j)), bias);
+                const uint16_t bits = static_cast<uint16_t>(
+                        _mm_movemask_epi8(_mm_cmpgt_epi8(v, t)));
+                std::memcpy(reinterpret_cast<uint8_t*>(dst) + j / 8, &bits, sizeof(bits));
+            }
+#endif
+            for (; j < width; j++)
+                dst[j / 64] |= static_cast<uint64_t>(src[j] > threshold) << (j % 64);
+        }
+
+        /**
+         * Threshold and pack an 8-bit frame. Multichannel pixels are set if
+         * any channel is greater than the threshold.
+         * @param src 8-bit frame.
+         * @param threshold Pixels greater than this are set.
+         * @param dst Packed mask.
+         */
+        inline void pack(const cv::Mat& src, const uint8_t threshold, cv::Mat& dst) {
+
+            CV_Assert(src.depth() == CV_8U);
+
+            const int words = wordsPerRow(src.cols);
+            dst.create(src.rows, words * sizeof(uint64_t), CV_8UC1);
+
+            const int channels = src.channels();
+            std::vector<uint8_t> row_max(channels > 1 ? src.cols : 0);
+
+            for (int i = 0; i < src.rows; i++) {
+
+                const uint8_t* row = src.ptr<uint8_t>(i);
+                if (channels > 1) {
+                    for (int j = 0; j < src.cols; j++) {
+                        uint8_t m = row[j * channels];
+                        for (int c = 1; c < channels; c++)
+                            m = std::max(m, row[j * channels + c]);
+                        row_max[j] = m;
+                    }
+                    row = row_max.data();
+                }
+
+                packRow(row, src.cols, threshold, dst.ptr<uint64_t>(i));
+            }
+        }
+
+        /**
+         * Expand a packed mask to one byte per pixel (0 or 255), e.g. for
+         * display.
+         * @param src Packed mask.
+         * @param width Frame width in pixels.
+         * @param dst CV_8UC1 mask.
+         */
+        inline void unpack(const cv::Mat& src, const int width, cv::Mat& dst) {
+
+            dst.create(src.rows, width, CV_8UC1);
+            for (int i = 0; i < src.rows; i++) {
+
+                const uint64_t* in = src.ptr<uint64_t>(i);
+                uint8_t* out = dst.ptr<uint8_t>(i);
+                for (int j = 0; j < width; j++)
+                    out[j] = ((in[j / 64] >> (j % 64)) & 1) ? 255 : 0;
+            }
+        }
+
+        /**
+         * Spatial moments of a packed mask, as cv::moments() would give for
+         * the unpacked binary image.
+         */
+        struct Moments {
+            double m00 {0};
+            double m10 {0};
+            double m01 {0};
+        };
+
+        /**
+         * Compute zeroth and first order moments with population counts. For
+         * each word, the sum of set bit indices is sum_b 2^b * popcount(w & M_b),
+         * where M_b selects bit indices that have bit b set, so the column
+         * moment needs 7 popcounts per 64 pixels and no per-pixel work.
+         * @param src Packed mask.
+         * @return Moments.
+         */
+        inline Moments moments(const cv::Mat& src) {
+
+            static const uint64_t index_bit[6] {
+                0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull,
+                0xF0F0F0F0F0F0F0F0ull, 0xFF00FF00FF00FF00ull,
+                0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+            };
+
+            const int words = src.cols / sizeof(uint64_t);
+            uint64_t m00 = 0, m10 = 0, m01 = 0;
+
+            for (int i = 0; i < src.rows; i++) {
+
+                const uint64_t* row = src.ptr<uint64_t>(i);
+                uint64_t row_count = 0;
+
+                for (int w = 0; w < words; w++) {
+
+                    const uint64_t word = row[w];
+                    if (!word)
+                        continue;
+
+                    const uint64_t n = __builtin_popcountll(word);
+                    uint64_t index_sum = 0;
+                    for (int b = 0; b < 6; b++)
+                        index_sum += static_cast<uint64_t>(
+                                __builtin_popcountll(word & index_bit[b])) << b;
+
+                    row_count += n;
+                    m10 += 64 * w * n + index_sum;
+                }
+
+                m00 += row_count;
+                m01 += static_cast<uint64_t>(i) * row_count;
+            }
+
+            Moments m;
+            m.m00 = static_cast<double>(m00);
+            m.m10 = static_cast<double>(m10);
+            m.m01 = static_cast<double>(m01);
+            return m;
+        }
+
+        /**
+         * Error message for components that receive packed masks but cannot
+         * use them.
+         * @param source_name Name of the SOURCE that published the mask.
+         */
+        inline std::string sourceError(const std::string& source_name) {
+            return source_name + " publishes bit packed masks, which are only "
+                   "accepted by posidet binary and view. Use framefilt "
+                   "threshold with pack = false to publish an 8-bit mask.";
+        }
+
+    } // namespace packed
+
+} // namespace oat
+
+#endif // PACKEDMASK_H
@@ -0,0 +1,79 @@
+//******************************************************************************
+//* File:   RawFrameFormat.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef RAWFRAMEFORMAT_H
+#define RAWFRAMEFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace oat {
+
+    /**
+     * Uncompressed frame file layout:
+     *
+     *   [RawFrameHeader][padding to data_offset]
+     *   [frame 0][frame 1]...[frame count - 1]
+     *   [optional sample index: count x uint64_t]
+     *
+     * Frames are stored back to back with no row padding, so a frame can be
+     * wrapped in a cv::Mat directly from a memory mapping of the file. The
+     * data offset is page aligned. If present, the sample index holds the
+     * sample number of each frame, which allows gaps due to dropped frames
+     * and seeking by sample number.
+     */
+    struct RawFrameHeader {
+
+        static const uint32_t VERSION {1};
+        static const uint64_t DATA_ALIGNMENT {4096};
+
+        RawFrameHeader() :
+          version(VERSION)
+        , rows(0)
+        , cols(0)
+        , type(0)
+        , frame_bytes(0)
+        , count(0)
+        , data_offset(DATA_ALIGNMENT)
+        , index_offset(0)
+        , frame_rate(0.0) {
+            std::memset(magic, 0, sizeof(magic));
+            std::strncpy(magic, "OATRAW1", sizeof(magic) - 1);
+        }
+
+        bool valid(void) const {
+            return std::strncmp(magic, "OATRAW1", sizeof(magic)) == 0 &&
+                   version == VERSION;
+        }
+
+        char magic[8];
+        uint32_t version;
+        uint32_t rows;
+        uint32_t cols;
+        int32_t type;           // OpenCV matrix type (e.g. CV_8UC3)
+        uint64_t frame_bytes;   // rows * cols * element size
+        uint64_t count;         // Number of frames
+        uint64_t data_offset;   // Byte offset of frame 0
+        uint64_t index_offset;  // Byte offset of the sample index. 0 if none.
+        double frame_rate;      // Hz
+    };
+
+} // namespace oat
+
+#endif // RAWFRAMEFORMAT_H
@@ -0,0 +1,134 @@
+//******************************************************************************
+//* File:   UndistortMap.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef UNDISTORTMAP_H
+#define UNDISTORTMAP_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/calib3d.hpp>
+
+namespace oat {
+
+    /**
+     * Lens distortion correction using precomputed remap tables. The
+     * rectification map is built once for a given frame size, in fixed point
+     * format, and then applied to each frame in parallel row bands. This is
+     * much cheaper than cv::undistort, which rebuilds the map on every call.
+     */
+    class UndistortMap {
+    public:
+
+        /**
+         * Set the camera model. The map is rebuilt on the next call to
+         * apply().
+         * @param camera_matrix 3x3 camera matrix.
+         * @param distortion_coefficients Distortion coefficients.
+         * @param fisheye True to use the fisheye camera model.
+         */
+        void set_model(const cv::Mat& camera_matrix,
+                       const cv::Mat& distortion_coefficients,
+                       const bool fisheye = false) {
+
+            camera_matrix.convertTo(camera_matrix_, CV_64F);
+            distortion_coefficients.convertTo(distortion_coefficients_, CV_64F);
+            fisheye_ = fisheye;
+            map_size_ = cv::Size();
+        }
+
+        /**
+         * Build the remap tables for a frame size.
+         * @param size Frame size.
+         */
+        void build(const cv::Size& size) {
+
+            if (fisheye_) {
+                cv::fisheye::initUndistortRectifyMap(camera_matrix_,
+                        distortion_coefficients_, cv::Matx33d::eye(),
+                        camera_matrix_, size, CV_16SC2, map1_, map2_);
+            } else {
+                cv::initUndistortRectifyMap(camera_matrix_,
+                        distortion_coefficients_, cv::noArray(),
+                        camera_matrix_, size, CV_16SC2, map1_, map2_);
+            }
+
+            map_size_ = size;
+        }
+
+        /**
+         * Undistort a frame. The map is built on first use and whenever the
+         * frame size changes.
+         * @param src Distorted frame.
+         * @param dst Undistorted frame. Reallocated only if its size or type
+         * does not match src. Must not share data with src.
+         */
+        void apply(const cv::Mat& src, cv::Mat& dst) {
+
+            if (src.size() != map_size_)
+                build(src.size());
+
+            dst.create(src.size(), src.type());
+            cv::parallel_for_(cv::Range(0, src.rows),
+                    RemapBand(src, dst, map1_, map2_),
+                    cv::getNumThreads());
+        }
+
+    private:
+
+        cv::Mat camera_matrix_;
+        cv::Mat distortion_coefficients_;
+        bool fisheye_ {false};
+
+        // Fixed point remap tables: map1_ holds integer coordinates (CV_16SC2)
+        // and map2_ holds interpolation table indices (CV_16UC1)
+        cv::Size map_size_;
+        cv::Mat map1_, map2_;
+
+        // Remaps a band of output rows. Each band reads from the whole source
+        // frame and writes only its own rows of the destination.
+        class RemapBand : public cv::ParallelLoopBody {
+        public:
+
+            RemapBand(const cv::Mat& src, cv::Mat& dst,
+                      const cv::Mat& map1, const cv::Mat& map2) :
+              src_(src)
+            , dst_(dst)
+            , map1_(map1)
+            , map2_(map2) { }
+
+            void operator()(const cv::Range& rows) const override {
+
+                cv::Mat dst_band = dst_.rowRange(rows);
+                cv::remap(src_, dst_band,
+                          map1_.rowRange(rows), map2_.rowRange(rows),
+                          cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+            }
+
+        private:
+
+            const cv::Mat& src_;
+            cv::Mat& dst_;
+            const cv::Mat& map1_;
+            const cv::Mat& map2_;
+        };
+    };
+
+} // namespace oat
+
+#endif // UNDISTORTMAP_H
@@ -0,0 +1,135 @@
+//******************************************************************************
+//* File:   BatchRunner.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+#include "../../lib/utility/IOFormat.h"
+
+#include "BatchRunner.h"
+
+BatchRunner::BatchRunner(const std::string& output_dir) :
+  output_dir(output_dir)
+, job_memory_bytes(0) {
+
+}
+
+uint64_t BatchRunner::availableMemory() {
+
+    // Prefer the kernel's estimate, which accounts for reclaimable page cache
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    uint64_t value;
+    std::string unit;
+
+    while (meminfo >> key >> value) {
+        std::getline(meminfo, unit);
+        if (key == "MemAvailable:")
+            return value * 1024;
+    }
+
+    return static_cast<uint64_t>(sysconf(_SC_AVPHYS_PAGES)) 
+            * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::vector<BatchRunner::JobResult> BatchRunner::runJobs(const std::vector<Job>& jobs,
+        const size_t max_concurrent_jobs,
+        const volatile sig_atomic_t& quit) {
+
+    std::vector<JobResult> results(jobs.size(), JobResult {false, 0.0});
+    std::atomic<size_t> next_job {0};
+    std::mutex io_mutex;
+
+    // Memory admission
+    std::mutex admit_mutex;
+    size_t running_jobs = 0;
+
+    // The process ID keeps concurrent batches from colliding as well
+    const std::string batch_token = "b" + std::to_string(getpid()) + "_";
+
+    auto worker = [&]() {
+
+        size_t i;
+        while (!quit && (i = next_job++) < jobs.size()) {
+
+            // Hold the job until there is room for it. At least one job is 
+            // always allowed to run so that the batch makes progress.
+            if (job_memory_bytes > 0) {
+                std::unique_lock<std::mutex> lk(admit_mutex);
+                while (!quit && running_jobs > 0 && availableMemory() < job_memory_bytes) {
+                    lk.unlock();
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                    lk.lock();
+                }
+                running_jobs++;
+            }
+
+            const Job &job = jobs[i];
+            const std::string prefix = batch_token + std::to_string(i) + "_";
+            const std::string log_file = output_dir + "/" + job.name + ".log";
+
+            {
+                std::lock_guard<std::mutex> lk(io_mutex);
+                std::cout << oat::whoMessage(name, "Started " + job.name + ".\n");
+            }
+
+            auto tick = std::chrono::steady_clock::now();
+
+            bool ok = false;
+            try {
+                ok = pipeline.run(prefix, job.variables, log_file, quit);
+            } catch (const std::runtime_error& ex) {
+                std::lock_guard<std::mutex> lk(io_mutex);
+                std::cerr << oat::whoError(name, ex.what());
+            }
+
+            std::chrono::duration<double> elapsed = 
+                    std::chrono::steady_clock::now() - tick;
+            results[i] = JobResult {ok, elapsed.count()};
+
+            if (job_memory_bytes > 0) {
+                std::lock_guard<std::mutex> lk(admit_mutex);
+                running_jobs--;
+            }
+
+            std::lock_guard<std::mutex> lk(io_mutex);
+            if (ok)
+                std::cout << oat::whoMessage(name, "Finished " + job.name + ".\n");
+            else
+                std::cerr << oat::whoError(name, job.name + " failed. See "
+                        + log_file + ".\n");
+        }
+    };
+
+    size_t n = std::max<size_t>(1, std::min(max_concurrent_jobs, jobs.size()));
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < n; i++)
+        workers.emplace_back(worker);
+
+    for (auto &w : workers)
+        w.join();
+
+    return results;
+}
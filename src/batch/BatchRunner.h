@@ -0,0 +1,109 @@
+//******************************************************************************
+//* File:   BatchRunner.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef BATCHRUNNER_H
+#define	BATCHRUNNER_H
+
+#include <csignal>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Pipeline.h"
+
+/**
+ * Abstract base class for offline batch processing. A batch runner breaks
+ * some work into jobs, each of which is a separate instance of a Pipeline,
+ * and runs the jobs concurrently.
+ */
+class BatchRunner {
+public:
+
+    /**
+     * Abstract batch runner.
+     * @param output_dir Directory to which job logs and outputs are written.
+     */
+    BatchRunner(const std::string& output_dir);
+
+    virtual ~BatchRunner() { }
+
+    // Batch runners must be configurable via file
+    virtual void configure(const std::string& file_name, const std::string& key) = 0;
+
+    /**
+     * Run all jobs to completion.
+     * @param quit Interrupt flag. When set, running jobs are stopped.
+     * @return true if all jobs completed successfully.
+     */
+    virtual bool run(const volatile sig_atomic_t& quit) = 0;
+
+    std::string get_name(void) const { return name; }
+
+protected:
+
+    /**
+     * Single pipeline instance.
+     */
+    struct Job {
+        std::string name;
+        Pipeline::Variables variables;
+    };
+
+    /**
+     * Outcome of a single job.
+     */
+    struct JobResult {
+        bool success;
+        double seconds; // Wall time
+    };
+
+    // Runner name
+    std::string name;
+
+    // Where job outputs are written
+    std::string output_dir;
+
+    // The processing chain that each job runs
+    Pipeline pipeline;
+
+    // Estimated memory used by a single job. If non-zero, a job is only
+    // started while at least this much memory is available.
+    uint64_t job_memory_bytes;
+
+    /**
+     * Run jobs, at most max_concurrent_jobs at a time. Each job's stream
+     * names are prefixed with a unique token so that jobs cannot collide in
+     * shared memory. Job output is written to output_dir/<job name>.log.
+     * @param jobs Jobs to run.
+     * @param max_concurrent_jobs Maximum number of simultaneous jobs.
+     * @param quit Interrupt flag.
+     * @return Result of each job.
+     */
+    std::vector<JobResult> runJobs(const std::vector<Job>& jobs,
+                                   const size_t max_concurrent_jobs,
+                                   const volatile sig_atomic_t& quit);
+
+    /**
+     * Memory available for new processes.
+     * @return Available memory in bytes.
+     */
+    static uint64_t availableMemory(void);
+};
+
+#endif	/* BATCHRUNNER_H */
@@ -0,0 +1,273 @@
+//******************************************************************************
+//* File:   FileRunner.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <boost/filesystem.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/rapidjson/filewritestream.h"
+#include "../../lib/rapidjson/prettywriter.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "FileRunner.h"
+
+namespace bfs = boost::filesystem;
+
+FileRunner::FileRunner(const std::vector<std::string>& inputs,
+        const std::string& output_dir,
+        const size_t max_jobs) :
+  BatchRunner(output_dir)
+, inputs(inputs)
+, max_jobs(max_jobs)
+, extensions({".avi", ".mpg", ".mpeg", ".mp4", ".mov", ".mkv"}) {
+
+    name = "batch[" + std::to_string(inputs.size()) + " inputs]";
+}
+
+void FileRunner::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"extensions", "job_memory"};
+    options.insert(options.end(), Pipeline::options.begin(), Pipeline::options.end());
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Processing chain
+        pipeline.configure(this_config);
+
+        // Video extensions
+        oat::config::Array ext_array;
+        if (oat::config::getArray(this_config, "extensions", ext_array)) {
+
+            extensions.clear();
+            for (auto &e : ext_array->array_of<std::string>())
+                extensions.push_back(e->get());
+        }
+
+        // Per-job memory estimate (MB)
+        double job_memory_mb;
+        if (oat::config::getValue(this_config, "job_memory", job_memory_mb, 0.0))
+            job_memory_bytes = static_cast<uint64_t>(job_memory_mb * 1024 * 1024);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+std::vector<std::string> FileRunner::listVideos() const {
+
+    std::vector<std::string> videos;
+
+    for (auto &in : inputs) {
+
+        bfs::path path(in.c_str());
+
+        if (bfs::is_directory(path)) {
+
+            // Sort so that the job order does not depend on the file system
+            std::vector<std::string> dir_videos;
+            for (bfs::directory_iterator it(path), end; it != end; ++it) {
+
+                if (!bfs::is_regular_file(it->status()))
+                    continue;
+
+                std::string ext = it->path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+                if (std::find(extensions.begin(), extensions.end(), ext) != extensions.end())
+                    dir_videos.push_back(it->path().string());
+            }
+
+            std::sort(dir_videos.begin(), dir_videos.end());
+            videos.insert(videos.end(), dir_videos.begin(), dir_videos.end());
+
+        } else if (bfs::is_regular_file(path)) {
+            videos.push_back(in);
+        } else {
+            throw (std::runtime_error("Input " + in + " does not exist.\n"));
+        }
+    }
+
+    return videos;
+}
+
+bool FileRunner::run(const volatile sig_atomic_t& quit) {
+
+    auto videos = listVideos();
+    if (videos.empty())
+        throw (std::runtime_error("No videos were found in the supplied inputs.\n"));
+
+    // One job per video. Outputs are named after the video, so make sure
+    // that identically named videos in different folders stay distinct.
+    std::vector<Job> jobs;
+    std::vector<int64_t> frame_counts;
+    std::set<std::string> names;
+
+    for (auto &v : videos) {
+
+        std::string stem = bfs::path(v).stem().string();
+        std::string job_name = stem;
+        for (int i = 1; names.count(job_name); i++)
+            job_name = stem + "_" + std::to_string(i);
+        names.insert(job_name);
+
+        Job job;
+        job.name = job_name;
+        job.variables["$VIDEO"] = v;
+        job.variables["$OUTDIR"] = output_dir;
+        job.variables["$NAME"] = job_name;
+        jobs.push_back(job);
+
+        // For throughput accounting only
+        cv::VideoCapture cap(v);
+        frame_counts.push_back(cap.isOpened() ?
+                static_cast<int64_t>(cap.get(cv::CAP_PROP_FRAME_COUNT)) : -1);
+    }
+
+    // Each stage is a process that can saturate a core
+    size_t concurrent_jobs = max_jobs;
+    if (concurrent_jobs == 0) {
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        concurrent_jobs = std::max<size_t>(1, threads / pipeline.get_number_of_stages());
+    }
+
+    if (job_memory_bytes > 0) {
+        size_t memory_jobs = std::max<uint64_t>(1, availableMemory() / job_memory_bytes);
+        concurrent_jobs = std::min(concurrent_jobs, memory_jobs);
+    }
+
+    std::cout << oat::whoMessage(name, "Processing " + std::to_string(jobs.size())
+            + " videos, " + std::to_string(concurrent_jobs) + " at a time.\n");
+
+    auto tick = std::chrono::steady_clock::now();
+    auto results = runJobs(jobs, concurrent_jobs, quit);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tick;
+
+    writeSummary(jobs, results, frame_counts, elapsed.count(), concurrent_jobs);
+
+    for (auto &r : results) {
+        if (!r.success)
+            return false;
+    }
+
+    return true;
+}
+
+void FileRunner::writeSummary(const std::vector<Job>& jobs,
+        const std::vector<JobResult>& results,
+        const std::vector<int64_t>& frame_counts,
+        const double total_seconds,
+        const size_t concurrent_jobs) {
+
+    std::string summary_file = output_dir + "/summary.json";
+    FILE* fp = fopen(summary_file.c_str(), "wb");
+    if (!fp)
+        throw (std::runtime_error("Unable to open " + summary_file + ".\n"));
+
+    char buffer[65536];
+    rapidjson::FileWriteStream stream(fp, buffer, sizeof(buffer));
+    rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(stream);
+
+    size_t succeeded = 0;
+    int64_t total_frames = 0;
+
+    writer.StartObject();
+
+    writer.String("jobs");
+    writer.StartArray();
+    for (size_t i = 0; i < jobs.size(); i++) {
+
+        const JobResult& r = results[i];
+        double fps = (r.seconds > 0 && frame_counts[i] > 0) ? frame_counts[i] / r.seconds : 0.0;
+
+        writer.StartObject();
+        writer.String("name");
+        writer.String(jobs[i].name.c_str());
+        writer.String("video");
+        writer.String(jobs[i].variables.at("$VIDEO").c_str());
+        writer.String("success");
+        writer.Bool(r.success);
+        writer.String("seconds");
+        writer.Double(r.seconds);
+        writer.String("frames");
+        writer.Int64(frame_counts[i]);
+        writer.String("frames_per_second");
+        writer.Double(fps);
+        writer.EndObject();
+
+        if (r.success) {
+            succeeded++;
+            total_frames += std::max<int64_t>(0, frame_counts[i]);
+        }
+    }
+    writer.EndArray();
+
+    double total_fps = total_seconds > 0 ? total_frames / total_seconds : 0.0;
+
+    writer.String("total");
+    writer.StartObject();
+    writer.String("videos");
+    writer.Uint64(jobs.size());
+    writer.String("succeeded");
+    writer.Uint64(succeeded);
+    writer.String("concurrent_jobs");
+    writer.Uint64(concurrent_jobs);
+    writer.String("seconds");
+    writer.Double(total_seconds);
+    writer.String("frames");
+    writer.Int64(total_frames);
+    writer.String("frames_per_second");
+    writer.Double(total_fps);
+    writer.EndObject();
+
+    writer.EndObject();
+    stream.Flush();
+    fclose(fp);
+
+    // Tell user
+    std::stringstream msg;
+    msg << std::fixed << std::setprecision(1)
+        << succeeded << "/" << jobs.size() << " videos processed in "
+        << total_seconds << " s (" << total_frames << " frames, "
+        << total_fps << " frames/s).\n";
+
+    std::cout << oat::whoMessage(name, msg.str())
+              << oat::whoMessage(name, "Summary written to " + summary_file + ".\n");
+}
@@ -0,0 +1,75 @@
+//******************************************************************************
+//* File:   FileRunner.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef FILERUNNER_H
+#define	FILERUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "BatchRunner.h"
+
+/**
+ * Process many videos, one pipeline instance per video. Jobs are scheduled
+ * across cores with concurrency limited by both the number of hardware
+ * threads and available memory. A throughput summary is written when all
+ * jobs are complete.
+ */
+class FileRunner : public BatchRunner {
+public:
+
+    /**
+     * Multi-file video processor.
+     * @param inputs Videos, or directories containing videos, to process.
+     * @param output_dir Directory to which outputs are written.
+     * @param max_jobs Maximum number of concurrent jobs. 0 to determine
+     * automatically.
+     */
+    FileRunner(const std::vector<std::string>& inputs,
+               const std::string& output_dir,
+               const size_t max_jobs = 0);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+    bool run(const volatile sig_atomic_t& quit);
+
+private:
+
+    std::vector<std::string> inputs;
+    size_t max_jobs;
+
+    // Extensions of files to process when an input is a directory
+    std::vector<std::string> extensions;
+
+    /**
+     * Expand inputs into a list of video files.
+     * @return Video files to process.
+     */
+    std::vector<std::string> listVideos(void) const;
+
+    /**
+     * Write per-job and total throughput to output_dir/summary.json.
+     */
+    void writeSummary(const std::vector<Job>& jobs,
+                      const std::vector<JobResult>& results,
+                      const std::vector<int64_t>& frame_counts,
+                      const double total_seconds,
+                      const size_t concurrent_jobs);
+};
+
+#endif	/* FILERUNNER_H */
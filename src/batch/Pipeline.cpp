@@ -0,0 +1,247 @@
+//******************************************************************************
+//* File:   Pipeline.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/tokenizer.hpp>
+
+#include "Pipeline.h"
+
+namespace bip = boost::interprocess;
+
+const std::vector<std::string> Pipeline::options {"stages", "streams", "launch_delay", "stop_timeout"};
+
+Pipeline::Pipeline() :
+  launch_delay(500)
+, stop_timeout(10000) {
+
+}
+
+void Pipeline::configure(const oat::config::Table& table) {
+
+    // Stages
+    oat::config::Array stage_array;
+    oat::config::getArray(table, "stages", stage_array, true);
+
+    stages.clear();
+    for (auto &s : stage_array->array_of<std::string>())
+        stages.push_back(s->get());
+
+    if (stages.empty())
+        throw (std::runtime_error("At least one pipeline stage must be specified.\n"));
+
+    // Streams
+    oat::config::Array stream_array;
+    if (oat::config::getArray(table, "streams", stream_array)) {
+
+        streams.clear();
+        for (auto &s : stream_array->array_of<std::string>())
+            streams.push_back(s->get());
+    }
+
+    // Launch delay
+    double delay_sec;
+    if (oat::config::getValue(table, "launch_delay", delay_sec, 0.0))
+        launch_delay = std::chrono::milliseconds(static_cast<int64_t>(delay_sec * 1000));
+
+    // Time allowed to stop after SIGINT
+    double timeout_sec;
+    if (oat::config::getValue(table, "stop_timeout", timeout_sec, 0.0))
+        stop_timeout = std::chrono::milliseconds(static_cast<int64_t>(timeout_sec * 1000));
+}
+
+bool Pipeline::uses(const std::string& variable) const {
+
+    for (auto &s : stages) {
+        if (s.find(variable) != std::string::npos)
+            return true;
+    }
+
+    return false;
+}
+
+std::vector<std::string> Pipeline::expand(const std::string& stage,
+        const std::string& prefix,
+        const Variables& variables) const {
+
+    // Split on spaces, respecting double quotes
+    boost::escaped_list_separator<char> separator('\\', ' ', '\"');
+    boost::tokenizer< boost::escaped_list_separator<char> > tokens(stage, separator);
+
+    std::vector<std::string> args;
+    for (auto t : tokens) {
+
+        // Repeated spaces result in empty tokens
+        if (t.empty())
+            continue;
+
+        // Stream names are matched as whole arguments only
+        if (std::find(streams.begin(), streams.end(), t) != streams.end()) {
+            args.push_back(prefix + t);
+            continue;
+        }
+
+        for (auto &v : variables)
+            boost::replace_all(t, v.first, v.second);
+
+        args.push_back(t);
+    }
+
+    if (args.empty())
+        throw (std::runtime_error("Empty pipeline stage.\n"));
+
+    // Stages are oat subcommands
+    args[0] = "oat-" + args[0];
+
+    return args;
+}
+
+bool Pipeline::run(const std::string& prefix,
+        const Variables& variables,
+        const std::string& log_file,
+        const volatile sig_atomic_t& quit) const {
+
+    // Expand all stages before forking anything
+    std::vector< std::vector<std::string> > commands;
+    for (auto &s : stages)
+        commands.push_back(expand(s, prefix, variables));
+
+    int log_fd = open(log_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (log_fd < 0)
+        throw (std::runtime_error("Unable to open log file " + log_file + ".\n"));
+
+    std::vector<pid_t> pids;
+    bool launched = true;
+
+    for (auto &c : commands) {
+
+        if (quit)
+            break;
+
+        std::vector<char *> argv;
+        for (auto &a : c)
+            argv.push_back(const_cast<char *>(a.c_str()));
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+
+        if (pid == 0) {
+
+            // Child process: redirect output to the log and become the stage
+            dup2(log_fd, STDOUT_FILENO);
+            dup2(log_fd, STDERR_FILENO);
+            execvp(argv[0], argv.data());
+
+            std::perror(argv[0]);
+            _exit(127);
+
+        } else if (pid < 0) {
+
+            launched = false;
+            break;
+        }
+
+        pids.push_back(pid);
+
+        // Give this stage time to create its sinks before its sources start
+        std::this_thread::sleep_for(launch_delay);
+    }
+
+    // If a stage failed to launch, the rest of the chain cannot finish
+    bool success = waitForStages(pids, quit, !launched) && launched;
+
+    close(log_fd);
+
+    // Remove any segments left behind by stages that did not exit cleanly.
+    // All servers append "_sh_mem" to stream names.
+    for (auto &s : streams)
+        bip::shared_memory_object::remove((prefix + s + "_sh_mem").c_str());
+
+    return success;
+}
+
+bool Pipeline::waitForStages(std::vector<pid_t>& pids,
+        const volatile sig_atomic_t& quit,
+        const bool stop) const {
+
+    bool success = true;
+    bool interrupted = false;
+    bool killed = false;
+    std::chrono::steady_clock::time_point interrupt_time;
+    size_t remaining = pids.size();
+
+    auto interrupt = [&]() {
+        for (auto &q : pids)
+            if (q > 0) kill(q, SIGINT);
+        interrupted = true;
+        interrupt_time = std::chrono::steady_clock::now();
+    };
+
+    if (stop)
+        interrupt();
+
+    while (remaining > 0) {
+
+        for (auto &p : pids) {
+
+            if (p <= 0)
+                continue;
+
+            int status;
+            if (waitpid(p, &status, WNOHANG) != p)
+                continue;
+
+            p = 0;
+            remaining--;
+
+            // A failed stage stalls the rest of the pipeline, so stop it
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                success = false;
+                if (!interrupted)
+                    interrupt();
+            }
+        }
+
+        if (quit && !interrupted) {
+            interrupt();
+            success = false;
+        }
+
+        // Stages blocked on a stream whose other end has died do not see
+        // SIGINT, so they are killed once the timeout has passed
+        if (interrupted && !killed && remaining > 0 && 
+                std::chrono::steady_clock::now() - interrupt_time >= stop_timeout) {
+            for (auto &q : pids)
+                if (q > 0) kill(q, SIGKILL);
+            killed = true;
+            success = false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    return success;
+}
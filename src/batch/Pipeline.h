@@ -0,0 +1,107 @@
+//******************************************************************************
+//* File:   Pipeline.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef PIPELINE_H
+#define	PIPELINE_H
+
+#include <chrono>
+#include <csignal>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+
+/**
+ * A chain of Oat components defined in a configuration file. Each stage is an
+ * oat command line (e.g. "framefilt mog raw filt"). Stages are launched in the
+ * order they are defined, so consumers should be listed before producers,
+ * just as in a shell script.
+ */
+class Pipeline {
+public:
+
+    // $NAME -> value substitutions applied to each stage
+    using Variables = std::map<std::string, std::string>;
+
+    // Configuration keys used by the pipeline definition
+    static const std::vector<std::string> options;
+
+    Pipeline();
+
+    /**
+     * Read the pipeline definition from a component configuration table.
+     * @param table Configuration table containing stages, streams, etc.
+     */
+    void configure(const oat::config::Table& table);
+
+    /**
+     * Run a single instance of the pipeline to completion. Stream names are
+     * prefixed so that concurrent instances do not share memory segments.
+     * Output of all stages is written to the log file.
+     * @param prefix Prefix applied to each stream name.
+     * @param variables Variable substitutions for this instance.
+     * @param log_file File to which stage output is written.
+     * @param quit Interrupt flag. When set, all stages are sent SIGINT, and
+     * SIGKILL if they have not exited after stop_timeout.
+     * @return true if all stages exited successfully.
+     */
+    bool run(const std::string& prefix,
+             const Variables& variables,
+             const std::string& log_file,
+             const volatile sig_atomic_t& quit) const;
+
+    /**
+     * Check if a variable (e.g. "$VIDEO") is used by any stage.
+     * @param variable Variable name including the leading '$'.
+     * @return true if the variable appears in at least one stage.
+     */
+    bool uses(const std::string& variable) const;
+
+    // Accessors
+    size_t get_number_of_stages(void) const { return stages.size(); }
+
+private:
+
+    // Stage command lines, unexpanded
+    std::vector<std::string> stages;
+
+    // Stream names to place in a per-instance namespace
+    std::vector<std::string> streams;
+
+    // Time to wait between starting each stage
+    std::chrono::milliseconds launch_delay;
+
+    // Time allowed for stages to exit after SIGINT before they are killed
+    std::chrono::milliseconds stop_timeout;
+
+    std::vector<std::string> expand(const std::string& stage,
+                                    const std::string& prefix,
+                                    const Variables& variables) const;
+
+    // Wait for all stages to exit. If stop is true, or a stage fails, or
+    // quit is set, the stages are sent SIGINT and, after stop_timeout,
+    // SIGKILL.
+    bool waitForStages(std::vector<pid_t>& pids,
+                       const volatile sig_atomic_t& quit,
+                       const bool stop) const;
+};
+
+#endif	/* PIPELINE_H */
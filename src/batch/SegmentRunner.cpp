@@ -0,0 +1,227 @@
+//******************************************************************************
+//* File:   SegmentRunner.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/filesystem.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/rapidjson/document.h"
+#include "../../lib/rapidjson/filereadstream.h"
+#include "../../lib/rapidjson/filewritestream.h"
+#include "../../lib/rapidjson/prettywriter.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "SegmentRunner.h"
+
+namespace bfs = boost::filesystem;
+
+SegmentRunner::SegmentRunner(const std::string& video_file,
+        const std::string& output_dir,
+        const size_t number_of_segments) :
+  BatchRunner(output_dir)
+, video_file(video_file)
+, number_of_segments(number_of_segments)
+, overlap(0)
+, position_file("$OUTDIR/$NAME.json") {
+
+    name = "batch[" + bfs::path(video_file).filename().string() + "]";
+}
+
+void SegmentRunner::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"overlap", "positions"};
+    options.insert(options.end(), Pipeline::options.begin(), Pipeline::options.end());
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Processing chain
+        pipeline.configure(this_config);
+
+        // Warm-up frames
+        oat::config::getValue(this_config, "overlap", overlap, (int64_t)0);
+
+        // Position file to stitch
+        oat::config::getValue(this_config, "positions", position_file);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+
+    // Without a frame range, every segment would process the whole video
+    if (!pipeline.uses("$START") || !pipeline.uses("$STOP")) {
+        throw (std::runtime_error("Segment pipelines must serve frames in "
+                "[$START, $STOP) (e.g. frameserve file raw -f $VIDEO "
+                "--start-frame $START --stop-frame $STOP --max-rate).\n"));
+    }
+}
+
+bool SegmentRunner::run(const volatile sig_atomic_t& quit) {
+
+    cv::VideoCapture cap(video_file);
+    if (!cap.isOpened())
+        throw (std::runtime_error("Unable to open " + video_file + ".\n"));
+
+    int64_t frame_count = static_cast<int64_t>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+    cap.release();
+
+    if (frame_count <= 0)
+        throw (std::runtime_error("Unable to determine the length of " + video_file + ".\n"));
+
+    size_t k = std::min<size_t>(number_of_segments, frame_count);
+
+    // Evenly spaced boundaries. frameserve checks where each seek lands
+    // and decodes forward from the start of the file when it is not
+    // exact, so sample numbers match frame indices in every segment.
+    std::vector<int64_t> bounds;
+    for (size_t i = 0; i <= k; i++)
+        bounds.push_back((frame_count * i) / k);
+
+    std::string stem = bfs::path(video_file).stem().string();
+    std::vector<Job> jobs;
+    std::vector<std::string> position_files;
+
+    for (size_t i = 0; i < k; i++) {
+
+        Job job;
+        job.name = stem + "_seg" + std::to_string(i);
+        job.variables["$VIDEO"] = video_file;
+        job.variables["$START"] = std::to_string(std::max<int64_t>(0, bounds[i] - overlap));
+        job.variables["$STOP"] = std::to_string(bounds[i + 1]);
+        job.variables["$OUTDIR"] = output_dir;
+        job.variables["$NAME"] = job.name;
+
+        std::string pos_file = position_file;
+        for (auto &v : job.variables)
+            boost::replace_all(pos_file, v.first, v.second);
+
+        position_files.push_back(pos_file);
+        jobs.push_back(job);
+    }
+
+    std::cout << oat::whoMessage(name, "Processing " + std::to_string(frame_count)
+            + " frames in " + std::to_string(k) + " segments.\n");
+
+    auto results = runJobs(jobs, k, quit);
+
+    for (auto &r : results) {
+        if (!r.success)
+            return false;
+    }
+
+    if (!position_file.empty()) {
+
+        std::string combined = output_dir + "/" + stem + ".json";
+        stitchPositions(position_files, bounds, combined);
+
+        std::cout << oat::whoMessage(name, "Positions written to " + combined + ".\n");
+    }
+
+    return true;
+}
+
+void SegmentRunner::stitchPositions(const std::vector<std::string>& files,
+        const std::vector<int64_t>& bounds,
+        const std::string& combined_file) {
+
+    FILE* out_fp = fopen(combined_file.c_str(), "wb");
+    if (!out_fp)
+        throw (std::runtime_error("Unable to open " + combined_file + ".\n"));
+
+    char write_buffer[65536];
+    rapidjson::FileWriteStream out_stream(out_fp, write_buffer, sizeof(write_buffer));
+    rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(out_stream);
+
+    char read_buffer[65536];
+
+    for (size_t i = 0; i < files.size(); i++) {
+
+        FILE* in_fp = fopen(files[i].c_str(), "rb");
+        if (!in_fp) {
+            fclose(out_fp);
+            throw (std::runtime_error("Unable to open " + files[i] + ".\n"));
+        }
+
+        rapidjson::FileReadStream in_stream(in_fp, read_buffer, sizeof(read_buffer));
+        rapidjson::Document doc;
+        doc.ParseStream(in_stream);
+        fclose(in_fp);
+
+        if (doc.HasParseError() || !doc.IsObject()
+                || !doc.HasMember("positions") || !doc["positions"].IsArray()) {
+            fclose(out_fp);
+            throw (std::runtime_error(files[i] + " is not a valid position file.\n"));
+        }
+
+        // The first segment supplies the header
+        if (i == 0) {
+
+            writer.StartObject();
+
+            if (doc.HasMember("oat_version")) {
+                writer.String("oat_version");
+                doc["oat_version"].Accept(writer);
+            }
+
+            if (doc.HasMember("header")) {
+                writer.String("header");
+                doc["header"].Accept(writer);
+            }
+
+            writer.String("positions");
+            writer.StartArray();
+        }
+
+        // Each entry is an object keyed by sample number. Drop warm-up
+        // samples and anything past the end of this segment.
+        const rapidjson::Value& positions = doc["positions"];
+        for (auto it = positions.Begin(); it != positions.End(); ++it) {
+
+            const rapidjson::Value& entry = *it;
+            if (!entry.IsObject() || entry.MemberBegin() == entry.MemberEnd())
+                continue;
+
+            int64_t sample = std::stoll(entry.MemberBegin()->name.GetString());
+            if (sample >= bounds[i] && sample < bounds[i + 1])
+                entry.Accept(writer);
+        }
+    }
+
+    writer.EndArray();
+    writer.EndObject();
+    out_stream.Flush();
+    fclose(out_fp);
+}
@@ -0,0 +1,74 @@
+//******************************************************************************
+//* File:   SegmentRunner.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef SEGMENTRUNNER_H
+#define	SEGMENTRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "BatchRunner.h"
+
+/**
+ * Split a single video into time segments and process each segment with its
+ * own pipeline instance. Each segment starts a number of frames early so that
+ * stateful components (e.g. background models, Kalman filters) can settle
+ * before the segment proper begins. Recorded positions are then stitched
+ * back together in sample order, discarding the warm-up samples.
+ */
+class SegmentRunner : public BatchRunner {
+public:
+
+    /**
+     * Segment-parallel video processor.
+     * @param video_file Video to process.
+     * @param output_dir Directory to which outputs are written.
+     * @param number_of_segments Number of segments to split the video into.
+     */
+    SegmentRunner(const std::string& video_file,
+                  const std::string& output_dir,
+                  const size_t number_of_segments);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+    bool run(const volatile sig_atomic_t& quit);
+
+private:
+
+    std::string video_file;
+    size_t number_of_segments;
+
+    // Frames processed before each segment's start and then discarded
+    int64_t overlap;
+
+    // Position file written by each segment's pipeline, before expansion
+    std::string position_file;
+
+    /**
+     * Join the position files of each segment, keeping the samples in
+     * [begin, end) of each.
+     * @param files Position file written by each segment.
+     * @param bounds Segment boundaries. Segment k spans [bounds[k], bounds[k+1]).
+     * @param combined_file Stitched position file.
+     */
+    void stitchPositions(const std::vector<std::string>& files,
+                         const std::vector<int64_t>& bounds,
+                         const std::string& combined_file);
+};
+
+#endif	/* SEGMENTRUNNER_H */
@@ -0,0 +1,246 @@
+//******************************************************************************
+//* File:   oat batch main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <opencv2/core.hpp>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "BatchRunner.h"
+#include "SegmentRunner.h"
+#include "FileRunner.h"
+
+namespace po = boost::program_options;
+namespace bfs = boost::filesystem;
+
+volatile sig_atomic_t quit = 0;
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: batch [INFO]\n"
+              << "   or: batch TYPE INPUT CONFIGURATION\n"
+              << "Process recorded data offline using a pipeline of Oat components "
+              << "defined in a configuration file.\n\n"
+              << "TYPE:\n"
+              << "  segment: Split a single video into segments that are processed in "
+              << "parallel.\n"
+              << "    files: Process many videos concurrently.\n\n"
+              << "INPUT:\n"
+              << "  Path to the video file to process. If TYPE=files, any number of "
+              << "videos or folders containing videos.\n\n"
+              << options << "\n";
+}
+
+// Signal handler to ensure shared resources are cleaned on exit due to ctrl-c
+void sigHandler(int s) {
+    quit = 1;
+}
+
+int main(int argc, char *argv[]) {
+
+    std::signal(SIGINT, sigHandler);
+
+    std::string type;
+    std::vector<std::string> inputs;
+    std::string output_dir = ".";
+    size_t number_of_segments = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_jobs = 0;
+    std::string config_file;
+    std::string config_key;
+    po::options_description visible_options("OPTIONAL ARGUMENTS");
+
+    std::unordered_map<std::string, char> type_hash;
+    type_hash["segment"] = 'a';
+    type_hash["files"] = 'b';
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+                ("help", "Produce help message.")
+                ("version,v", "Print version information.")
+                ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("folder,f", po::value<std::string>(&output_dir),
+                "The path to the folder to which logs and processing results will be saved.")
+                ("segments,n", po::value<size_t>(&number_of_segments),
+                "If TYPE=segment, the number of segments to split the video into. "
+                "Defaults to the number of hardware threads.")
+                ("jobs,j", po::value<size_t>(&max_jobs),
+                "If TYPE=files, the maximum number of videos to process at once. "
+                "By default, this is determined from the number of hardware threads, "
+                "the number of pipeline stages, and available memory.")
+                ("config-file,c", po::value<std::string>(&config_file), "Configuration file.")
+                ("config-key,k", po::value<std::string>(&config_key), "Configuration key.")
+                ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+                ("type", po::value<std::string>(&type), "Batch TYPE.")
+                ("inputs", po::value< std::vector<std::string> >(&inputs),
+                "Input files to process.")
+                ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("type", 1);
+        positional_options.add("inputs", -1);
+
+        visible_options.add(options).add(config);
+
+        po::options_description all_options("ALL OPTIONS");
+        all_options.add(options).add(config).add(hidden);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Batch Processor version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (!variable_map.count("type")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A TYPE must be specified.\n");
+            return -1;
+        }
+
+        if (!variable_map.count("inputs")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("An INPUT must be specified.\n");
+            return -1;
+        }
+
+        if (!variable_map.count("config-file") || !variable_map.count("config-key")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A configuration file and key defining the "
+                      "pipeline must be specified.\n");
+            return -1;
+        }
+
+        if (number_of_segments == 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("At least one segment must be specified.\n");
+            return -1;
+        }
+
+        bfs::path path(output_dir.c_str());
+        if (!bfs::exists(path) || !bfs::is_directory(path)) {
+            std::cerr << oat::Error("Requested output folder, " + output_dir
+                      + ", does not exist, or is not a valid directory.\n");
+            return -1;
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    // Create the specified TYPE of batch runner
+    std::shared_ptr<BatchRunner> runner;
+
+    switch (type_hash[type]) {
+        case 'a':
+        {
+            if (inputs.size() > 1) {
+                printUsage(visible_options);
+                std::cerr << oat::Error("TYPE=segment accepts a single INPUT.\n");
+                return -1;
+            }
+            runner = std::make_shared<SegmentRunner>(inputs[0], output_dir, number_of_segments);
+            break;
+        }
+        case 'b':
+        {
+            runner = std::make_shared<FileRunner>(inputs, output_dir, max_jobs);
+            break;
+        }
+        default:
+        {
+            printUsage(visible_options);
+            std::cerr << oat::Error("Invalid TYPE specified.\n");
+            return -1;
+        }
+    }
+
+    // The business
+    try {
+
+        runner->configure(config_file, config_key);
+
+        // Tell user
+        std::cout << oat::whoMessage(runner->get_name(),
+                "Writing output to " + output_dir + ".\n")
+                << oat::whoMessage(runner->get_name(),
+                "Press CTRL+C to exit.\n");
+
+        // Run until all jobs are complete or ctrl-c
+        bool success = runner->run(quit);
+
+        // Tell user
+        std::cout << oat::whoMessage(runner->get_name(), "Exiting.\n");
+
+        // Exit
+        return success ? 0 : -1;
+
+    } catch (const cpptoml::parse_exception& ex) {
+        std::cerr << oat::whoError(runner->get_name(), "Failed to parse configuration file " + config_file + "\n")
+                  << oat::whoError(runner->get_name(), ex.what())
+                  << "\n";
+    } catch (const std::runtime_error& ex) {
+        std::cerr << oat::whoError(runner->get_name(), ex.what())
+                  << "\n";
+    } catch (const cv::Exception& ex) {
+        std::cerr << oat::whoError(runner->get_name(), ex.what())
+                  << "\n";
+    } catch (...) {
+        std::cerr << oat::whoError(runner->get_name(), "Unknown exception.\n");
+    }
+
+    // Exit failure
+    return -1;
+}
@@ -22,6 +22,8 @@
 #include <boost/filesystem.hpp>
 #include <opencv2/core/mat.hpp>
 
+#include "../../lib/utility/PackedMask.h"
+
 #include "Calibrator.h"
 
 namespace bfs = boost::filesystem;
@@ -31,6 +33,9 @@ bool Calibrator::process(void) {
     // Only proceed with processing if we are getting a valid frame
     if (frame_source_.getSharedMat(current_frame_)) {
 
+        if (frame_source_.get_current_packed_width() > 0)
+            throw (std::runtime_error(oat::packed::sourceError(frame_source_.get_name())));
+
         // Use the current frame for calibration
         calibrate(current_frame_);
     }
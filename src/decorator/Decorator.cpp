@@ -25,6 +25,8 @@
 #include <ctime>
 #include <cmath>
 
+#include "../../lib/utility/PackedMask.h"
+
 Decorator::Decorator(const std::vector<std::string>& position_source_names,
         const std::string& frame_source_name,
         const std::string& frame_sink_name) :
@@ -82,6 +84,13 @@ bool Decorator::decorateFrame() {
     // Get the image to be decorated
     if (!frame_read_success) {
         frame_read_success = frame_source.getSharedMat(current_frame);
+
+        if (frame_read_success && frame_source.get_current_packed_width() > 0)
+            throw (std::runtime_error(oat::packed::sourceError(frame_source.get_name())));
+
+        // Positions are in full frame coordinates
+        frame_offset = frame_source.get_current_offset();
+        frame_scale = frame_source.get_current_scale();
     }
     
     boost::dynamic_bitset<>::size_type i = position_read_required.find_first();
@@ -142,7 +151,8 @@ void Decorator::drawPosition() {
 
     for (auto position : source_positions) {
         if (position->position_valid) {
-            cv::circle(current_frame, position->position, position_circle_radius, cv::Scalar(0, 0, 255), 2);
+            cv::Point2d pos = (position->position - frame_offset) / frame_scale;
+            cv::circle(current_frame, pos, position_circle_radius, cv::Scalar(0, 0, 255), 2);
         }
     }
 }
@@ -150,8 +160,9 @@ void Decorator::drawPosition() {
 void Decorator::drawHeading() {
     for (auto position : source_positions) {
         if (position->position_valid && position->heading_valid) {
-            cv::Point2d start = position->position - (heading_line_length * position->heading);
-            cv::Point2d end = position->position + (heading_line_length * position->heading);
+            cv::Point2d pos = (position->position - frame_offset) / frame_scale;
+            cv::Point2d start = pos - (heading_line_length * position->heading);
+            cv::Point2d end = pos + (heading_line_length * position->heading);
 
             // Draw arrow
             cv::line(current_frame, start, end, cv::Scalar(255, 0, 0), 2, 8);
@@ -169,8 +180,9 @@ void Decorator::drawHeading() {
 void Decorator::drawVelocity() {
     for (auto position : source_positions) {
         if (position->velocity_valid && position->position_valid) {        
-            cv::Point2d end = position->position + (velocity_scale_factor * position->velocity);
-            cv::line(current_frame, position->position, end, cv::Scalar(0, 255, 0), 2, 8);
+            cv::Point2d pos = (position->position - frame_offset) / frame_scale;
+            cv::Point2d end = pos + (velocity_scale_factor / frame_scale) * position->velocity;
+            cv::line(current_frame, pos, end, cv::Scalar(0, 255, 0), 2, 8);
         }
     }
 }
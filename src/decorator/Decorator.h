@@ -69,6 +69,8 @@ private:
 
     // Image data
     cv::Mat current_frame;
+    cv::Point2d frame_offset;
+    double frame_scale {1.0};
 
     // Mat client object for receiving frames
     oat::MatClient frame_source;
@@ -19,6 +19,9 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <string>
 #include <iostream>
 #include <opencv2/core.hpp>
@@ -34,13 +37,39 @@
 
 #include "BackgroundSubtractor.h"
 
+namespace {
+
+    // Subtract the running average background from one row of 8-bit pixel
+    // values and update the average in the same pass. The inner loop has no
+    // branches so that it can be vectorized by the compiler.
+    template <bool ABSDIFF>
+    void subtractAndUpdateRow(uchar* frame, float* model, const int n,
+                              const float alpha, const float threshold) {
+
+        for (int k = 0; k < n; k++) {
+
+            const float diff = static_cast<float>(frame[k]) - model[k];
+
+            // Foreground does not bleed into the background
+            const float weight = std::abs(diff) <= threshold ? alpha : 0.0f;
+            model[k] += weight * diff;
+
+            const float out = ABSDIFF ? std::abs(diff) : std::max(diff, 0.0f);
+            frame[k] = static_cast<uchar>(std::min(out + 0.5f, 255.0f));
+        }
+    }
+}
+
 BackgroundSubtractor::BackgroundSubtractor(const std::string& source_name, const std::string& sink_name) :
   FrameFilter(source_name, sink_name) { }
 
 void BackgroundSubtractor::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"background"};
+    std::vector<std::string> options {"background", 
+                                      "mode", 
+                                      "adaptation_coeff", 
+                                      "update_threshold"};
     
     // This will throw cpptoml::parse_exception if a file 
     // with invalid TOML is provided
@@ -64,9 +93,23 @@ void BackgroundSubtractor::configure(const std::string& config_file, const std::
                 throw (std::runtime_error("File \"" + background_img_path + "\" could not be read."));
             }
 
-            background_set = true;
+            setBackgroundImage(background_frame);
+        }
+
+        std::string mode_str;
+        if (oat::config::getValue(this_config, "mode", mode_str)) {
+            if (mode_str == "subtract")
+                mode = Mode::SUBTRACT;
+            else if (mode_str == "absdiff")
+                mode = Mode::ABSDIFF;
+            else
+                throw (std::runtime_error(oat::configValueError("mode", config_key, 
+                        config_file, "must be 'subtract' or 'absdiff'")));
         }
 
+        oat::config::getValue(this_config, "adaptation_coeff", adaptation_coeff, 0.0, 1.0);
+        oat::config::getValue(this_config, "update_threshold", update_threshold, 0.0);
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
@@ -81,6 +124,7 @@ void BackgroundSubtractor::setBackgroundImage(const cv::Mat& frame) {
     background_frame = frame.clone();
 //#endif
 
+    background_frame.convertTo(background_model, CV_32F);
     background_set = true;
 }
 
@@ -96,7 +140,12 @@ cv::Mat BackgroundSubtractor::filter(cv::Mat& frame) {
 //        cv::cuda::subtract(current_frame, background_frame, result_frame);
 //        result_frame.download(frame);
 //#else
-        frame = frame - background_frame;
+        if (adaptation_coeff > 0) 
+            subtractAndUpdate(frame);
+        else if (mode == Mode::ABSDIFF)
+            cv::absdiff(frame, background_frame, frame);
+        else
+            cv::subtract(frame, background_frame, frame);
 //#endif
     } else {
 
@@ -107,3 +156,34 @@ cv::Mat BackgroundSubtractor::filter(cv::Mat& frame) {
 
     return frame;
 }
+
+void BackgroundSubtractor::subtractAndUpdate(cv::Mat& frame) {
+
+    if (frame.depth() != CV_8U)
+        throw (std::runtime_error("Adaptive background subtraction requires 8-bit frames."));
+
+    if (frame.size() != background_model.size() || 
+        frame.channels() != background_model.channels())
+        throw (std::runtime_error("Frame and background sizes do not match."));
+
+    const float alpha = static_cast<float>(adaptation_coeff);
+    const float threshold = update_threshold > 0 ? 
+        static_cast<float>(update_threshold) : FLT_MAX;
+
+    int rows = frame.rows;
+    int n = frame.cols * frame.channels();
+    if (frame.isContinuous() && background_model.isContinuous()) {
+        n *= rows;
+        rows = 1;
+    }
+
+    for (int i = 0; i < rows; i++) {
+
+        if (mode == Mode::ABSDIFF)
+            subtractAndUpdateRow<true>(frame.ptr<uchar>(i), 
+                    background_model.ptr<float>(i), n, alpha, threshold);
+        else
+            subtractAndUpdateRow<false>(frame.ptr<uchar>(i), 
+                    background_model.ptr<float>(i), n, alpha, threshold);
+    }
+}
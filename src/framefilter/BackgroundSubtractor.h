@@ -23,7 +23,8 @@
 #include "FrameFilter.h"
 
 /**
- * A basic background subtractor.
+ * A basic background subtractor. The background is either static or an
+ * exponential running average of the frame stream.
  */
 class BackgroundSubtractor : public FrameFilter {
 public:
@@ -32,13 +33,25 @@ public:
      * A basic background subtractor.
      * Subtract a frame image from a frame stream. The background frame is 
      * the first frame obtained from the SOURCE frame stream, or can be 
-     * supplied via configuration file.
+     * supplied via configuration file. If an adaptation coefficient is
+     * configured, the background is updated with each frame.
      * @param source_name raw frame source name
      * @param sink_name filtered frame sink name
      */
     BackgroundSubtractor(const std::string& source_name, const std::string& sink_name);
 
     void configure(const std::string& config_file, const std::string& config_key);
+
+    /**
+     * Get the static background frame that is subtracted, with saturation,
+     * from each frame.
+     * @return Background frame. Empty if the background has not been set,
+     * is adaptive, or is not subtracted with saturation.
+     */
+    cv::Mat get_background(void) const { 
+        return background_set && adaptation_coeff == 0 && mode == Mode::SUBTRACT ? 
+            background_frame : cv::Mat(); 
+    }
     
 private:
     
@@ -58,6 +71,24 @@ private:
     // Set the background frame
     void setBackgroundImage(const cv::Mat&);
 
+    // Saturating subtraction (frame - background) or absolute difference
+    enum class Mode {
+        SUBTRACT,
+        ABSDIFF
+    };
+    Mode mode {Mode::SUBTRACT};
+
+    // Running average background. Each frame updates the model by 
+    // adaptation_coeff * (frame - model). 0 for a static background.
+    double adaptation_coeff {0.0};
+    cv::Mat background_model; // CV_32F
+
+    // Pixels that differ from the background by more than this are treated
+    // as foreground and do not update the model. 0 to update all pixels.
+    double update_threshold {0.0};
+
+    void subtractAndUpdate(cv::Mat& frame);
+
 };
 
 #endif	/* BACKGROUNDSUBTRACTOR_H */
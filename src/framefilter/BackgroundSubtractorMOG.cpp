@@ -19,6 +19,8 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <opencv2/core.hpp>
@@ -41,15 +43,13 @@ BackgroundSubtractorMOG::BackgroundSubtractorMOG(const std::string& source_name,
 
 #ifdef OAT_USE_CUDA
     background_subtractor = cv::cuda::createBackgroundSubtractorMOG(/*defaults OK?*/);
-#else
-    background_subtractor = cv::createBackgroundSubtractorMOG2(/*defaults OK?*/);
 #endif
 }
 
 void BackgroundSubtractorMOG::configure(const std::string& config_file, const std::string& config_key) { 
 
     // Available options
-    std::vector<std::string> options {"learning_coeff"};
+    std::vector<std::string> options {"learning_coeff", "tiles"};
     
     // This will throw cpptoml::parse_exception if a file 
     // with invalid TOML is provided
@@ -68,6 +68,11 @@ void BackgroundSubtractorMOG::configure(const std::string& config_file, const st
         // Learning coefficient
         oat::config::getValue(this_config, "learning_coeff", learning_coeff, 0.0, 1.0);
 
+        // Number of tiles. 0 for one per thread.
+        int64_t val;
+        if (oat::config::getValue(this_config, "tiles", val, (int64_t)0))
+            num_tiles = val;
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
@@ -83,9 +88,59 @@ cv::Mat BackgroundSubtractorMOG::filter(cv::Mat& frame) {
         current_frame.setTo(0, background_mask);
         current_frame.download(frame);
 #else
-        background_subtractor->apply(frame, background_mask, learning_coeff);
-        frame.setTo(0, background_mask == 0);  
+        if (frame.size() != frame_size)
+            createTiles(frame.size());
+
+        cv::parallel_for_(cv::Range(0, tiles.size()),
+                TileBody(frame, tiles, learning_coeff),
+                tiles.size());
 #endif
         
         return frame;
 }
+
+#ifndef OAT_USE_CUDA
+void BackgroundSubtractorMOG::createTiles(const cv::Size& size) {
+
+    // Models are specific to a frame size, so they are discarded if it changes
+    int n = num_tiles > 0 ? num_tiles : cv::getNumThreads();
+    n = std::max(1, std::min(n, size.height));
+
+    tiles.clear();
+    tiles.resize(n);
+    for (int i = 0; i < n; i++) {
+
+        // Tiles span whole rows so that each one is a contiguous block of the
+        // frame and tiles do not share cache lines except at their seams
+        tiles[i].rows = cv::Range(i * size.height / n, (i + 1) * size.height / n);
+        tiles[i].background_subtractor = cv::createBackgroundSubtractorMOG2();
+    }
+
+    frame_size = size;
+}
+
+void BackgroundSubtractorMOG::TileBody::operator()(const cv::Range& range) const {
+
+    for (int t = range.start; t < range.end; t++) {
+
+        Tile& tile = tiles_[t];
+        cv::Mat band = frame_.rowRange(tile.rows);
+
+        // Each model is updated with the same learning rate the whole frame
+        // model would have been
+        tile.background_subtractor->apply(band, tile.background_mask, learning_coeff_);
+
+        // Zero background pixels. Shadows (127) and foreground (255) are kept.
+        const size_t elem_size = band.elemSize();
+        for (int i = 0; i < band.rows; i++) {
+
+            const uchar* m = tile.background_mask.ptr<uchar>(i);
+            uchar* f = band.ptr(i);
+            for (int j = 0; j < band.cols; j++) {
+                if (m[j] == 0)
+                    std::memset(f + j * elem_size, 0, elem_size);
+            }
+        }
+    }
+}
+#endif
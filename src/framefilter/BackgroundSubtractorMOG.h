@@ -26,10 +26,13 @@
 #include <opencv2/video.hpp>
 #endif
 
+#include <vector>
+
 #include "FrameFilter.h"
 
 /**
- * A MOG background subtractor.
+ * A MOG background subtractor. On the CPU, the frame is split into bands of
+ * rows, each with its own MOG2 model, which are updated in parallel.
  */
 class BackgroundSubtractorMOG : public FrameFilter {
 public:
@@ -56,8 +59,36 @@ private:
     cv::Ptr<cv::cuda::BackgroundSubtractorMOG> background_subtractor;
     cv::cuda::GpuMat current_frame, background_mask;
 #else
-    cv::Ptr<cv::BackgroundSubtractorMOG2> background_subtractor;
-    cv::Mat background_mask;
+    // MOG2 models each pixel independently, so a model per tile gives the
+    // same result as one model for the whole frame and tiles need no overlap
+    struct Tile {
+        cv::Range rows;
+        cv::Ptr<cv::BackgroundSubtractorMOG2> background_subtractor;
+        cv::Mat background_mask;
+    };
+
+    std::vector<Tile> tiles;
+    int num_tiles {0};
+    cv::Size frame_size;
+    void createTiles(const cv::Size& size);
+
+    // Updates the model of, and masks, a range of tiles
+    class TileBody : public cv::ParallelLoopBody {
+    public:
+
+        TileBody(cv::Mat& frame, std::vector<Tile>& tiles, const double learning_coeff) :
+          frame_(frame)
+        , tiles_(tiles)
+        , learning_coeff_(learning_coeff) { }
+
+        void operator()(const cv::Range& range) const override;
+
+    private:
+
+        cv::Mat& frame_;
+        std::vector<Tile>& tiles_;
+        const double learning_coeff_;
+    };
 #endif
     
     double learning_coeff;
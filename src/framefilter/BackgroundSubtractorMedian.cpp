@@ -0,0 +1,219 @@
+//******************************************************************************
+//* File:   BackgroundSubtractorMedian.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <string>
+#include <opencv2/core.hpp>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "BackgroundSubtractorMedian.h"
+
+namespace {
+
+    constexpr int BIN_SHIFT {4};
+    constexpr int BIN_WIDTH {1 << BIN_SHIFT};
+    constexpr int BINS {256 >> BIN_SHIFT};
+
+    // Replace the oldest sample in one row of histograms with the frame's
+    // values and find the new median bins
+    void sampleRow(const uchar* frame, uchar* counts, uchar* oldest,
+                   uchar* median_low, const int history, const int n) {
+
+        for (int k = 0; k < n; k++) {
+
+            uchar* c = counts + k * BINS;
+            const uchar bin = frame[k] >> BIN_SHIFT;
+
+            c[oldest[k]]--;
+            c[bin]++;
+            oldest[k] = bin;
+
+            int b = 0;
+            int below = c[0];
+            while (2 * below <= history)
+                below += c[++b];
+
+            median_low[k] = b << BIN_SHIFT;
+        }
+    }
+
+    // Subtract the background from one row of 8-bit pixel values and, if
+    // requested, step the background toward the frame, within its median
+    // bin, in the same pass. The inner loop has no branches so that it can
+    // be vectorized by the compiler.
+    template <bool ABSDIFF, bool UPDATE>
+    void subtractAndUpdateRow(uchar* frame, uchar* model, const uchar* median_low, const int n) {
+
+        for (int k = 0; k < n; k++) {
+
+            const uchar f = frame[k];
+            const uchar b = model[k];
+
+            if (UPDATE) {
+                const uchar lo = median_low[k];
+                const uchar stepped = b + (f > b) - (f < b);
+                model[k] = std::min<uchar>(std::max<uchar>(stepped, lo), lo + (BIN_WIDTH - 1));
+            }
+
+            frame[k] = ABSDIFF ? std::max(f, b) - std::min(f, b)
+                               : std::max(f, b) - b;
+        }
+    }
+}
+
+BackgroundSubtractorMedian::BackgroundSubtractorMedian(const std::string& source_name, const std::string& sink_name) :
+  FrameFilter(source_name, sink_name) { }
+
+void BackgroundSubtractorMedian::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"window", "mode"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        if (oat::config::getValue(this_config, "window", window, (int64_t)1)) {
+            sample_period = std::max<int64_t>(1, window / HISTORY);
+            frames_until_sample = sample_period;
+            update_period = std::max<int64_t>(1, window / 256);
+            frames_until_update = 0;
+        }
+
+        std::string mode_str;
+        if (oat::config::getValue(this_config, "mode", mode_str)) {
+            if (mode_str == "subtract")
+                mode = Mode::SUBTRACT;
+            else if (mode_str == "absdiff")
+                mode = Mode::ABSDIFF;
+            else
+                throw (std::runtime_error(oat::configValueError("mode", config_key,
+                        config_file, "must be 'subtract' or 'absdiff'")));
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void BackgroundSubtractorMedian::initializeModel(const cv::Mat& frame) {
+
+    background_model = frame.clone();
+
+    // Every sample in the history is the first frame
+    const size_t n = frame.total() * frame.channels();
+
+    counts.assign(n * BINS, 0);
+    history.resize(n * HISTORY);
+    median_low.resize(n);
+
+    size_t e = 0;
+    for (int i = 0; i < frame.rows; i++) {
+
+        const uchar* f = frame.ptr<uchar>(i);
+        const int row_n = frame.cols * frame.channels();
+
+        for (int k = 0; k < row_n; k++, e++) {
+
+            const uchar bin = f[k] >> BIN_SHIFT;
+            counts[e * BINS + bin] = HISTORY;
+            for (int j = 0; j < HISTORY; j++)
+                history[j * n + e] = bin;
+            median_low[e] = bin << BIN_SHIFT;
+        }
+    }
+
+    next_sample = 0;
+    frames_until_sample = sample_period;
+}
+
+cv::Mat BackgroundSubtractorMedian::filter(cv::Mat& frame) {
+
+    if (frame.depth() != CV_8U)
+        throw (std::runtime_error("Median background subtraction requires 8-bit frames."));
+
+    // First frame is the initial background
+    if (background_model.empty()) {
+        initializeModel(frame);
+        frame.setTo(0);
+        return frame;
+    }
+
+    if (frame.size() != background_model.size() ||
+        frame.channels() != background_model.channels())
+        throw (std::runtime_error("Frame and background sizes do not match."));
+
+    const bool update = frames_until_update == 0;
+    frames_until_update = update ? update_period - 1 : frames_until_update - 1;
+
+    const bool sample = --frames_until_sample == 0;
+    if (sample)
+        frames_until_sample = sample_period;
+
+    const size_t total = frame.total() * frame.channels();
+    uchar* oldest = history.data() + next_sample * total;
+    if (sample)
+        next_sample = (next_sample + 1) % HISTORY;
+
+    int rows = frame.rows;
+    int n = frame.cols * frame.channels();
+    if (frame.isContinuous()) {
+        n *= rows;
+        rows = 1;
+    }
+
+    for (int i = 0; i < rows; i++) {
+
+        const size_t e = static_cast<size_t>(i) * n;
+        uchar* f = frame.ptr<uchar>(i);
+        uchar* b = background_model.ptr<uchar>(i);
+        const uchar* lo = median_low.data() + e;
+
+        // Sampled before f is overwritten by the subtraction
+        if (sample)
+            sampleRow(f, counts.data() + e * BINS, oldest + e, median_low.data() + e, HISTORY, n);
+
+        if (mode == Mode::ABSDIFF) {
+            if (update)
+                subtractAndUpdateRow<true, true>(f, b, lo, n);
+            else
+                subtractAndUpdateRow<true, false>(f, b, lo, n);
+        } else {
+            if (update)
+                subtractAndUpdateRow<false, true>(f, b, lo, n);
+            else
+                subtractAndUpdateRow<false, false>(f, b, lo, n);
+        }
+    }
+
+    return frame;
+}
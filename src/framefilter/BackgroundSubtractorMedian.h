@@ -0,0 +1,92 @@
+//******************************************************************************
+//* File:   BackgroundSubtractorMedian.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef BACKGROUNDSUBTRACTORMEDIAN_H
+#define	BACKGROUNDSUBTRACTORMEDIAN_H
+
+#include <vector>
+
+#include "FrameFilter.h"
+
+/**
+ * A temporal median background subtractor. Each pixel keeps a coarse
+ * histogram (16 bins of 16 intensity levels) of HISTORY values sampled evenly
+ * over the window. The histogram is updated in O(1) when a sample enters and
+ * the oldest one leaves. The median bin is then the bin of the rolling
+ * median. Within that bin, the background steps one level at a time toward
+ * the current frame (McFarlane and Schofield, 1995). An animal that rests in
+ * one place for less than half of the window never moves the median bin, so
+ * it is not absorbed into the background unless it is within one bin of it.
+ */
+class BackgroundSubtractorMedian : public FrameFilter {
+public:
+
+    /**
+     * A temporal median background subtractor.
+     * The background is initialized with the first frame obtained from the
+     * SOURCE frame stream.
+     * @param source_name raw frame source name
+     * @param sink_name filtered frame sink name
+     */
+    BackgroundSubtractorMedian(const std::string& source_name, const std::string& sink_name);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+
+private:
+
+    /**
+     * Apply background subtraction.
+     * @param frame unfiltered frame
+     * @return filtered frame
+     */
+    cv::Mat filter(cv::Mat& frame);
+
+    // Saturating subtraction (frame - background) or absolute difference
+    enum class Mode {
+        SUBTRACT,
+        ABSDIFF
+    };
+    Mode mode {Mode::SUBTRACT};
+
+    // Number of frames over which the median is taken. A sample is added to
+    // the histograms once every window / HISTORY frames. The background
+    // steps within its median bin once every window / 256 frames, so it can
+    // cross a bin in one sample period.
+    int64_t window {1024};
+    int64_t sample_period {64};
+    int64_t frames_until_sample {0};
+    int64_t update_period {4};
+    int64_t frames_until_update {0};
+
+    // Background estimate. Same size and type as frames.
+    cv::Mat background_model;
+
+    // Rolling histograms, one per pixel channel. history holds the bin of
+    // each of the last HISTORY samples, oldest at next_sample, one plane per
+    // sample. median_low holds the lowest level of each median bin.
+    static constexpr int HISTORY {16};
+    std::vector<uchar> counts;
+    std::vector<uchar> history;
+    std::vector<uchar> median_low;
+    int next_sample {0};
+
+    void initializeModel(const cv::Mat& frame);
+};
+
+#endif	/* BACKGROUNDSUBTRACTORMEDIAN_H */
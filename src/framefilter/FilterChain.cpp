@@ -0,0 +1,180 @@
+//******************************************************************************
+//* File:   FilterChain.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <string>
+#include <opencv2/core.hpp>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "BackgroundSubtractor.h"
+#include "BackgroundSubtractorMOG.h"
+#include "BackgroundSubtractorMedian.h"
+#include "FrameMasker.h"
+#include "FrameThresholder.h"
+#include "Undistorter.h"
+
+#include "FilterChain.h"
+
+FilterChain::FilterChain(const std::string& source_name, const std::string& sink_name) :
+  FrameFilter(source_name, sink_name) { }
+
+void FilterChain::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"stages"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Each stage is specified as [TYPE] or [TYPE, KEY], where KEY is the
+        // table in this file used to configure the stage
+        oat::config::Array stage_array;
+        oat::config::getArray(this_config, "stages", stage_array, true);
+
+        for (auto& s : stage_array->nested_array()) {
+
+            auto fields = s->array_of<std::string>();
+            if (fields.size() < 1 || fields.size() > 2) {
+                throw (std::runtime_error(oat::configValueError("stages", config_key,
+                        config_file, "must be a TOML array of [TYPE] or [TYPE, KEY] arrays")));
+            }
+
+            Stage stage;
+            stage.type = fields[0]->get();
+
+            // Stages have no SOURCE or SINK of their own
+            if (stage.type == "mask")
+                stage.filter = std::make_shared<FrameMasker>("", "");
+            else if (stage.type == "bsub")
+                stage.filter = std::make_shared<BackgroundSubtractor>("", "");
+            else if (stage.type == "mog")
+                stage.filter = std::make_shared<BackgroundSubtractorMOG>("", "");
+            else if (stage.type == "median")
+                stage.filter = std::make_shared<BackgroundSubtractorMedian>("", "");
+            else if (stage.type == "threshold")
+                stage.filter = std::make_shared<FrameThresholder>("", "");
+            else if (stage.type == "undistort")
+                stage.filter = std::make_shared<Undistorter>("", "");
+            else
+                throw (std::runtime_error("Invalid stage TYPE '" + stage.type + "'. "
+                        "Must be 'mask', 'bsub', 'mog', 'median', 'threshold' or 'undistort'.\n"));
+
+            if (fields.size() == 2)
+                stage.filter->configure(config_file, fields[1]->get());
+
+            stages.push_back(stage);
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+
+    fuse_with_next.assign(stages.size(), false);
+    for (size_t i = 0; i + 1 < stages.size(); i++) {
+        fuse_with_next[i] = stages[i].type == "mask" && stages[i + 1].type == "bsub";
+    }
+}
+
+cv::Mat FilterChain::filter(cv::Mat& frame) {
+
+    cv::Mat result = frame;
+    crop_offset = cv::Point(0, 0);
+    packed_width = 0;
+
+    for (size_t i = 0; i < stages.size(); i++) {
+
+        // Packed masks cannot be filtered further
+        if (packed_width != 0)
+            throw (std::runtime_error("A packed threshold stage must be the "
+                    "last stage of a chain.\n"));
+
+        if (fuse_with_next[i] &&
+            maskAndSubtract(result, 
+                static_cast<const FrameMasker&>(*stages[i].filter),
+                static_cast<const BackgroundSubtractor&>(*stages[i + 1].filter))) {
+            i++;
+            continue;
+        }
+
+        result = stages[i].filter->applyFilter(result);
+        crop_offset += stages[i].filter->get_crop_offset();
+        packed_width = stages[i].filter->get_packed_width();
+    }
+
+    return result;
+}
+
+bool FilterChain::maskAndSubtract(cv::Mat& frame,
+                                  const FrameMasker& masker,
+                                  const BackgroundSubtractor& subtractor) {
+
+    cv::Mat mask = masker.get_mask();
+    cv::Mat background = subtractor.get_background();
+
+    // Until the background has been taken from the first (masked) frame, or
+    // for frame types the fused kernel does not handle, apply the stages
+    // separately
+    if (mask.empty() || background.empty() ||
+        frame.depth() != CV_8U || mask.type() != CV_8UC1 ||
+        background.type() != frame.type() ||
+        background.size() != frame.size() || mask.size() != frame.size()) {
+        return false;
+    }
+
+    // Masking then subtracting gives (f - b) inside the mask and
+    // saturate(0 - b) = 0 outside of it, so both can be done in one pass
+    const int channels = frame.channels();
+    int rows = frame.rows;
+    int cols = frame.cols;
+    if (frame.isContinuous() && mask.isContinuous() && background.isContinuous()) {
+        cols *= rows;
+        rows = 1;
+    }
+
+    for (int i = 0; i < rows; i++) {
+
+        uchar* f = frame.ptr<uchar>(i);
+        const uchar* b = background.ptr<uchar>(i);
+        const uchar* m = mask.ptr<uchar>(i);
+
+        for (int j = 0; j < cols; j++) {
+
+            const uchar keep = m[j] ? 0xFF : 0x00;
+            for (int c = 0; c < channels; c++) {
+                const int k = j * channels + c;
+                f[k] = (f[k] > b[k] ? f[k] - b[k] : 0) & keep;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+//******************************************************************************
+//* File:   FilterChain.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef FILTERCHAIN_H
+#define	FILTERCHAIN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameFilter.h"
+
+class FrameMasker;
+class BackgroundSubtractor;
+
+/**
+ * A chain of frame filters.
+ */
+class FilterChain : public FrameFilter {
+public:
+
+    /**
+     * A chain of frame filters.
+     * Apply several frame filters, in order, within a single component. This
+     * avoids a shared memory hop and a process per filter. Where possible,
+     * adjacent stages are fused into a single pass over the frame.
+     * @param source_name raw frame source name
+     * @param sink_name filtered frame sink name
+     */
+    FilterChain(const std::string& source_name, const std::string& sink_name);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+
+private:
+
+    /**
+     * Apply each stage of the chain.
+     * @param frame unfiltered frame
+     * @return filtered frame
+     */
+    cv::Mat filter(cv::Mat& frame);
+
+    struct Stage {
+        std::string type;
+        std::shared_ptr<FrameFilter> filter;
+    };
+
+    std::vector<Stage> stages;
+
+    // Stage index of each mask followed directly by a background subtractor.
+    // The pair is applied in one pass once the background is available.
+    std::vector<bool> fuse_with_next;
+
+    bool maskAndSubtract(cv::Mat& frame, 
+                         const FrameMasker& masker, 
+                         const BackgroundSubtractor& subtractor);
+};
+
+#endif	/* FILTERCHAIN_H */
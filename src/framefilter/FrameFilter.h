@@ -20,7 +20,9 @@
 #ifndef FRAMEFILT_H
 #define	FRAMEFILT_H
 
+#include <memory>
 #include <string>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 
 #ifdef OAT_USE_CUDA
@@ -31,6 +33,8 @@
 #include "../../lib/shmem/SharedMemoryManager.h"
 #include "../../lib/shmem/MatClient.h"
 #include "../../lib/shmem/MatServer.h"
+#include "../../lib/utility/OrderedWorkerPool.h"
+#include "../../lib/utility/PackedMask.h"
 
 /**
  * Abstract frame filter.
@@ -44,11 +48,17 @@ public:
      * All concrete frame filter types implement this ABC.
      * @param source_name Frame SOURCE name
      * @param sink_name Frame SINK name
+     * If both names are empty, no SOURCE or SINK is created and the filter
+     * can only be used through applyFilter(), e.g. as a stage of another
+     * filter.
      */
     FrameFilter(const std::string& source_name, const std::string& sink_name) :
-      name("framefilt[" + source_name + "->" + sink_name + "]")
-    , frame_source(source_name)
-    , frame_sink(sink_name) { 
+      name("framefilt[" + source_name + "->" + sink_name + "]") { 
+
+        if (!source_name.empty() || !sink_name.empty()) {
+            frame_source.reset(new oat::MatClient(source_name));
+            frame_sink.reset(new oat::MatServer(sink_name));
+        }
 
 #ifdef OAT_USE_CUDA
 
@@ -88,16 +98,58 @@ public:
      */
     bool processSample(void) {
 
+        if (worker_pool)
+            return processSampleParallel();
+
         // Only proceed with processing if we are getting a valid frame
-        if (frame_source.getSharedMat(current_frame)) {
+        if (frame_source->getSharedMat(current_frame)) {
+
+            checkUnpacked();
+
+            // Push filtered frame forward, along with frame_source sample
+            // number and the mapping from frame to full frame coordinates
+            cv::Mat filtered_frame = filter(current_frame);
+
+            const uint32_t sample = frame_source->get_current_sample_number();
+            const double source_scale = frame_source->get_current_scale();
+            const cv::Point2d offset = frame_source->get_current_offset() 
+                    + source_scale * cv::Point2d(crop_offset);
 
-            // Push filtered frame forward, along with frame_source sample number
-            frame_sink.pushMat(filter(current_frame), frame_source.get_current_sample_number());
+            frame_sink->pushMat(filtered_frame, sample, offset, source_scale, packed_width);
+            publishAuxiliary(sample, offset, source_scale);
         }
 
-        return (frame_source.getSourceRunState() == oat::ServerRunState::END);
+        return (frame_source->getSourceRunState() == oat::ServerRunState::END);
     }
 
+    /**
+     * Filter frames on several threads. Consecutive frames are given to the
+     * workers in turn, and filtered frames are published in sample order.
+     * Each worker keeps its own state, so stateful filters (e.g. background
+     * models) are updated from every K-th frame only.
+     * @param workers K filters, configured like this one and created without
+     * SOURCE or SINK. This filter's own filter() is not used.
+     */
+    void set_workers(const std::vector<std::shared_ptr<FrameFilter>>& workers) {
+
+        worker_filters = workers;
+        worker_pool.reset(new WorkerPool(workers.size(),
+            [this](const size_t w, Sample& s) {
+                FrameFilter& f = *worker_filters[w];
+                s.frame = f.filter(s.frame);
+                s.offset += s.scale * cv::Point2d(f.crop_offset);
+                s.packed_width = f.packed_width;
+                return s;
+            }));
+    }
+
+    /**
+     * Apply the filter function to a frame without using SOURCE or SINK.
+     * @param frame unfiltered frame. May be modified.
+     * @return filtered frame
+     */
+    cv::Mat applyFilter(cv::Mat& frame) { return filter(frame); }
+
     /**
      * Configure filter parameters.
      * @param config_file configuration file path
@@ -111,6 +163,20 @@ public:
      */
     std::string get_name(void) const { return name; }
 
+    /**
+     * Get the origin of the most recently filtered frame within the frame
+     * that was passed to the filter.
+     * @return Crop offset. (0, 0) unless the filter crops its output.
+     */
+    cv::Point get_crop_offset(void) const { return crop_offset; }
+
+    /**
+     * Get the width of the most recently filtered frame if it is a bit packed
+     * mask (see PackedMask.h).
+     * @return Width in pixels. 0 unless the filter packs its output.
+     */
+    int get_packed_width(void) const { return packed_width; }
+
 protected:
 
     /**
@@ -120,6 +186,23 @@ protected:
      */
     virtual cv::Mat filter(cv::Mat& frame) = 0;
 
+    // Filters that crop frames set this to the origin of their output
+    cv::Point crop_offset;
+
+    // Filters that publish bit packed masks set this to the mask width
+    int packed_width {0};
+
+    /**
+     * Publish streams other than SINK. Called after each filtered frame is
+     * published.
+     * @param sample_number Sample number of the filtered frame.
+     * @param offset Origin of the filtered frame in full frame coordinates.
+     * @param scale Size of filtered frame pixels in full frame pixels.
+     */
+    virtual void publishAuxiliary(const uint32_t sample_number,
+                                  const cv::Point2d& offset,
+                                  const double scale) { }
+
 private:
 
     // Filter name.
@@ -129,10 +212,67 @@ private:
     cv::Mat current_frame;
 
     // Frame SOURCE object for receiving raw frames
-    oat::MatClient frame_source;
+    std::unique_ptr<oat::MatClient> frame_source;
 
     // Frame SINK object for publishing filtered frames
-    oat::MatServer frame_sink;
+    std::unique_ptr<oat::MatServer> frame_sink;
+
+    // Frame parallel filtering
+    struct Sample {
+        cv::Mat frame;
+        uint32_t sample {0};
+        cv::Point2d offset;
+        double scale {1.0};
+        int packed_width {0};
+    };
+
+    using WorkerPool = oat::OrderedWorkerPool<Sample, Sample>;
+    std::vector<std::shared_ptr<FrameFilter>> worker_filters;
+    std::unique_ptr<WorkerPool> worker_pool;
+
+    // Filters work on pixels, not the words of a packed mask
+    void checkUnpacked(void) const {
+        if (frame_source->get_current_packed_width() > 0)
+            throw (std::runtime_error(oat::packed::sourceError(frame_source->get_name())));
+    }
+
+    void publish(const Sample& s) {
+        frame_sink->pushMat(s.frame, s.sample, s.offset, s.scale, s.packed_width);
+        publishAuxiliary(s.sample, s.offset, s.scale);
+    }
+
+    bool processSampleParallel(void) {
+
+        Sample s;
+        if (frame_source->getSharedMat(s.frame)) {
+
+            s.sample = frame_source->get_current_sample_number();
+            s.offset = frame_source->get_current_offset();
+            s.scale = frame_source->get_current_scale();
+            checkUnpacked();
+
+            // Make room by waiting for the oldest frame in flight
+            if (worker_pool->full())
+                publish(worker_pool->pop());
+
+            worker_pool->push(std::move(s));
+        }
+
+        // Publish whatever has finished, in order, without waiting
+        Sample done;
+        while (worker_pool->tryPop(done))
+            publish(done);
+
+        if (frame_source->getSourceRunState() == oat::ServerRunState::END) {
+
+            while (worker_pool->in_flight() > 0)
+                publish(worker_pool->pop());
+
+            return true;
+        }
+
+        return false;
+    }
 };
 
 #endif	/* FRAMEFILT_H */
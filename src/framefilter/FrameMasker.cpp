@@ -19,6 +19,7 @@
 
 #include "FrameMasker.h"
 
+#include <cstring>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
@@ -29,12 +30,12 @@
 
 FrameMasker::FrameMasker(const std::string& source_name, const std::string& sink_name, bool invert_mask) :
   FrameFilter(source_name, sink_name)
-, invert_mask(false) { }
+, invert_mask(invert_mask) { }
 
 void FrameMasker::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"mask"};
+    std::vector<std::string> options {"mask", "crop"};
     
     // This will throw cpptoml::parse_exception if a file 
     // with invalid TOML is provided
@@ -58,6 +59,12 @@ void FrameMasker::configure(const std::string& config_file, const std::string& c
             throw (std::runtime_error("File \"" + mask_path + "\" could not be read."));
         }
 
+        if (invert_mask)
+            roi_mask = roi_mask == 0;
+
+        oat::config::getValue(this_config, "crop", crop);
+
+        compileMask();
         mask_set = true;
 
     } else {
@@ -65,16 +72,64 @@ void FrameMasker::configure(const std::string& config_file, const std::string& c
     }
 }
 
+void FrameMasker::compileMask() {
+
+    std::vector<cv::Point> in_mask;
+    cv::findNonZero(roi_mask, in_mask);
+    if (in_mask.empty())
+        throw (std::runtime_error("Mask has no non-zero pixels."));
+
+    bounding_box = cv::boundingRect(in_mask);
+
+    // When cropping, only rows and columns within the bounding box are
+    // published, so spans are relative to its origin
+    cv::Rect region = crop ? bounding_box : cv::Rect(0, 0, roi_mask.cols, roi_mask.rows);
+
+    zero_spans.clear();
+    for (int i = 0; i < region.height; i++) {
+
+        const uchar* row = roi_mask.ptr<uchar>(region.y + i) + region.x;
+        int j = 0;
+        while (j < region.width) {
+
+            if (row[j] != 0) {
+                j++;
+                continue;
+            }
+
+            int start = j;
+            while (j < region.width && row[j] == 0)
+                j++;
+
+            zero_spans.push_back({i, start, j});
+        }
+    }
+}
+
 cv::Mat FrameMasker::filter(cv::Mat& frame) {
 
-    // Throws cv::Exception if there is a size mismatch between mask and frames
-    // received from SOURCE or in any case where setTo() assertions fail.
-    if (mask_set) {
-        
-        frame.setTo(0, roi_mask == 0);
+    if (!mask_set)
+        return frame;
+
+    if (frame.size() != roi_mask.size())
+        throw (std::runtime_error("Mask and frame dimensions do not match."));
+
+    cv::Mat masked = frame;
+    if (crop) {
+
+        // Copied into a continuous buffer that is reused between frames
+        frame(bounding_box).copyTo(cropped_frame);
+        masked = cropped_frame;
+        crop_offset = bounding_box.tl();
+    }
+
+    const size_t elem_size = masked.elemSize();
+    for (const auto& s : zero_spans) {
+        std::memset(masked.ptr(s.row) + s.start * elem_size, 0,
+                    (s.end - s.start) * elem_size);
     }
 
-    return frame;
+    return masked;
 }
 
 
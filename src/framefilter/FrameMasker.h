@@ -20,6 +20,8 @@
 #ifndef FRAMEMASKER_H
 #define	FRAMEMASKER_H
 
+#include <vector>
+
 #include "FrameFilter.h"
 
 /**
@@ -42,8 +44,23 @@ public:
                 bool invert_mask=false);
     
     void configure(const std::string& config_file, const std::string& config_key);
+
+    /**
+     * Get the mask.
+     * @return Mask frame. Empty if no mask has been set or if output frames
+     * are cropped, in which case the mask cannot be applied to the full frame.
+     */
+    cv::Mat get_mask(void) const { return mask_set && !crop ? roi_mask : cv::Mat(); }
     
 private:
+
+    // Run of masked-out pixels within a single row. Columns are in the
+    // coordinates of the output frame.
+    struct Span {
+        int row;
+        int start;
+        int end;   // One past the last pixel
+    };
     
     /**
      * Apply frame mask.
@@ -60,6 +77,16 @@ private:
     
     // Mask frames with an arbitrary ROI
     cv::Mat roi_mask;
+
+    // The mask compiled into runs of pixels to zero, and the bounding box of
+    // its non-zero pixels
+    std::vector<Span> zero_spans;
+    cv::Rect bounding_box;
+    void compileMask(void);
+
+    // Publish only the part of the frame within the mask's bounding box
+    bool crop = false;
+    cv::Mat cropped_frame;
 };
 
 #endif	/* FRAMEMASKER_H */
@@ -0,0 +1,127 @@
+//******************************************************************************
+//* File:   FramePyramid.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <string>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "FramePyramid.h"
+
+FramePyramid::FramePyramid(const std::string& source_name, const std::string& sink_name) :
+  FrameFilter(source_name, sink_name)
+, sink_name(sink_name) { }
+
+void FramePyramid::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"levels", "kernel"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        oat::config::getValue(this_config, "levels", num_levels, (int64_t)1, (int64_t)4);
+
+        std::string kernel_str;
+        if (oat::config::getValue(this_config, "kernel", kernel_str)) {
+            if (kernel_str == "box")
+                kernel = Kernel::BOX;
+            else if (kernel_str == "gaussian")
+                kernel = Kernel::GAUSSIAN;
+            else
+                throw (std::runtime_error(oat::configValueError("kernel", config_key,
+                        config_file, "must be 'box' or 'gaussian'")));
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+cv::Mat FramePyramid::filter(cv::Mat& frame) {
+
+    levels.resize(num_levels);
+
+    // Each level is reduced from the one above it, so only the first
+    // reduction reads the full frame
+    const cv::Mat* above = &frame;
+    for (auto& level : levels) {
+
+        if (kernel == Kernel::BOX) {
+
+            // Whole 2x2 blocks only, so that the scale is exactly 2 and
+            // INTER_AREA takes OpenCV's vectorized 2x2 averaging path. An
+            // odd last row or column is dropped.
+            const cv::Mat blocks = (*above)(cv::Rect(0, 0, 
+                    above->cols / 2 * 2, above->rows / 2 * 2));
+            cv::resize(blocks, level, 
+                    cv::Size(blocks.cols / 2, blocks.rows / 2), 0, 0, cv::INTER_AREA);
+        } else {
+
+            // Pixel i of the reduced level is pixel 2i of the blurred level
+            // above, for any size
+            cv::pyrDown(*above, level, 
+                    cv::Size((above->cols + 1) / 2, (above->rows + 1) / 2));
+        }
+
+        above = &level;
+    }
+
+    return frame;
+}
+
+void FramePyramid::publishAuxiliary(const uint32_t sample_number,
+                                    const cv::Point2d& offset,
+                                    const double scale) {
+
+    // Created on first use so that the number of levels is known
+    if (level_sinks.empty()) {
+        for (int64_t i = 1; i <= num_levels; i++) {
+            level_sinks.emplace_back(
+                    new oat::MatServer(sink_name + "_l" + std::to_string(i)));
+        }
+    }
+
+    // A box reduced pixel i averages pixels 2i and 2i + 1 above it, so it
+    // is centered half a pixel of the level above past 2i. A Gaussian
+    // reduced pixel is centered on pixel 2i.
+    const double center_shift = kernel == Kernel::BOX ? 0.5 : 0.0;
+
+    cv::Point2d level_offset = offset;
+    double level_scale = scale;
+    for (size_t i = 0; i < levels.size(); i++) {
+        level_offset += cv::Point2d(center_shift * level_scale, center_shift * level_scale);
+        level_scale *= 2.0;
+        level_sinks[i]->pushMat(levels[i], sample_number, level_offset, level_scale);
+    }
+}
@@ -0,0 +1,78 @@
+//******************************************************************************
+//* File:   FramePyramid.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef FRAMEPYRAMID_H
+#define	FRAMEPYRAMID_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameFilter.h"
+
+/**
+ * An image pyramid. Frames from SOURCE are published unchanged to SINK and
+ * successively downsampled by 2 in each dimension to produce lower resolution
+ * levels, which are published to SINK_l1, SINK_l2, etc. Each level carries
+ * its scale relative to the full frame so that positions detected in it are
+ * reported in full frame coordinates.
+ */
+class FramePyramid : public FrameFilter {
+public:
+
+    /**
+     * An image pyramid.
+     * @param source_name raw frame source name
+     * @param sink_name full resolution frame sink name. Also the prefix of
+     * the level sink names.
+     */
+    FramePyramid(const std::string& source_name, const std::string& sink_name);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+
+private:
+
+    /**
+     * Compute the pyramid levels.
+     * @param frame unfiltered frame
+     * @return unfiltered frame
+     */
+    cv::Mat filter(cv::Mat& frame);
+
+    void publishAuxiliary(const uint32_t sample_number,
+                          const cv::Point2d& offset,
+                          const double scale);
+
+    // 2x2 average or 5x5 Gaussian reduction
+    enum class Kernel {
+        BOX,
+        GAUSSIAN
+    };
+    Kernel kernel {Kernel::BOX};
+
+    // Number of downsampled levels
+    int64_t num_levels {2};
+
+    // Level frames and their SINKs. Level i + 1 is stored at index i.
+    const std::string sink_name;
+    std::vector<cv::Mat> levels;
+    std::vector<std::unique_ptr<oat::MatServer>> level_sinks;
+};
+
+#endif	/* FRAMEPYRAMID_H */
@@ -0,0 +1,83 @@
+//******************************************************************************
+//* File:   FrameThresholder.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <string>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/PackedMask.h"
+
+#include "FrameThresholder.h"
+
+FrameThresholder::FrameThresholder(const std::string& source_name, const std::string& sink_name) :
+  FrameFilter(source_name, sink_name) { }
+
+void FrameThresholder::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"threshold", "pack"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        oat::config::getValue(this_config, "threshold", threshold, (int64_t)0, (int64_t)255);
+        oat::config::getValue(this_config, "pack", pack);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+cv::Mat FrameThresholder::filter(cv::Mat& frame) {
+
+    if (frame.depth() != CV_8U)
+        throw (std::runtime_error("Thresholding requires 8-bit frames."));
+
+    if (pack) {
+        oat::packed::pack(frame, static_cast<uint8_t>(threshold), mask);
+        packed_width = frame.cols;
+        return mask;
+    }
+
+    // Any channel above threshold
+    if (frame.channels() > 1) {
+        cv::Mat pixels = frame.isContinuous() ? frame : frame.clone();
+        cv::Mat channel_max = pixels.reshape(1, pixels.total());
+        cv::reduce(channel_max, channel_max, 1, cv::REDUCE_MAX);
+        cv::threshold(channel_max.reshape(1, frame.rows), mask, threshold, 255, cv::THRESH_BINARY);
+    } else {
+        cv::threshold(frame, mask, threshold, 255, cv::THRESH_BINARY);
+    }
+
+    return mask;
+}
@@ -0,0 +1,60 @@
+//******************************************************************************
+//* File:   FrameThresholder.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef FRAMETHRESHOLDER_H
+#define	FRAMETHRESHOLDER_H
+
+#include "FrameFilter.h"
+
+/**
+ * A frame thresholder. Converts frames to binary masks, which are bit packed
+ * by default so that they take 1/8 of the bandwidth of an 8-bit mask.
+ */
+class FrameThresholder : public FrameFilter {
+public:
+
+    /**
+     * A frame thresholder.
+     * Pixels with any channel greater than the threshold are set.
+     * @param source_name raw frame source name
+     * @param sink_name filtered frame sink name
+     */
+    FrameThresholder(const std::string& source_name, const std::string& sink_name);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+
+private:
+
+    /**
+     * Apply threshold.
+     * @param frame unfiltered frame
+     * @return binary mask
+     */
+    cv::Mat filter(cv::Mat& frame);
+
+    // Pixels greater than this are set
+    int64_t threshold {0};
+
+    // Publish one bit (true) or one byte (false) per pixel
+    bool pack {true};
+
+    cv::Mat mask;
+};
+
+#endif	/* FRAMETHRESHOLDER_H */
@@ -22,6 +22,10 @@
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
 #include "Undistorter.h"
 
 Undistorter::Undistorter(const std::string& source_name, const std::string& sink_name) :
@@ -29,20 +33,82 @@ Undistorter::Undistorter(const std::string& source_name, const std::string& sink
 , camera_matrix_(cv::Matx33d::eye())
 , distortion_coefficients_ (cv::Mat::zeros(8, 1, CV_64F)) 
 {
-    // Nothing
+    updateModel();
 }
 
-void Undistorter::loadCalibration(const std::string& calibration_file) {
-    
-    
-    
+void Undistorter::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"calibration_file", "calibration_key"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        std::string calibration_file;
+        oat::config::getValue(this_config, "calibration_file", calibration_file, true);
+
+        std::string calibration_key = "calibration";
+        oat::config::getValue(this_config, "calibration_key", calibration_key);
+
+        loadCalibration(calibration_file, calibration_key);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void Undistorter::loadCalibration(const std::string& calibration_file,
+                                  const std::string& calibration_key) {
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table calibration;
+    calibration = cpptoml::parse_file(calibration_file);
+
+    auto table = std::make_shared<cpptoml::table>(calibration);
+
+    // Camera model. See CameraCalibrator::CameraModel.
+    int64_t model = 0;
+    oat::config::getValue(table, calibration_key + "-model", model, (int64_t)0, (int64_t)1);
+    fisheye_ = (model == 1);
+
+    oat::config::Array camera_array;
+    oat::config::getArray(table, calibration_key + "-camera-matrix", camera_array, 9, true);
+    auto camera_values = camera_array->array_of<double>();
+    for (int i = 0; i < 9; i++)
+        camera_matrix_(i / 3, i % 3) = camera_values[i]->get();
+
+    oat::config::Array dc_array;
+    oat::config::getArray(table, calibration_key + "-distortion-coeffs", dc_array, true);
+    auto dc_values = dc_array->array_of<double>();
+    distortion_coefficients_ = cv::Mat::zeros(dc_values.size(), 1, CV_64F);
+    for (size_t i = 0; i < dc_values.size(); i++)
+        distortion_coefficients_.at<double>(i) = dc_values[i]->get();
+
+    calibration_valid_ = true;
+    updateModel();
 }
 
+void Undistorter::updateModel() {
+
+    undistort_map_.set_model(cv::Mat(camera_matrix_), distortion_coefficients_, fisheye_);
+}
 
 cv::Mat Undistorter::filter(cv::Mat& frame) {
     
-    frame.copyTo(temp_matrix_);
-    cv::undistort(temp_matrix_, frame, camera_matrix_, distortion_coefficients_);
-    return frame;
+    // The map is applied straight into a reused output buffer. Its cost is
+    // paid when the first frame arrives.
+    undistort_map_.apply(frame, undistorted_frame_);
+    return undistorted_frame_;
 }
-
@@ -20,6 +20,7 @@
 #ifndef UNDISTORTER_H
 #define	UNDISTORTER_H
 
+#include "../../lib/utility/UndistortMap.h"
 
 #include "FrameFilter.h"
 
@@ -41,12 +42,25 @@ public:
      */
     Undistorter(const std::string& source_name, const std::string& sink_name);
 
-    void configure(const std::string& config_file, const std::string& config_key) { } ;
-    void loadCalibration(const std::string& calibration_file);
+    void configure(const std::string& config_file, const std::string& config_key);
+
+    /**
+     * Load camera model parameters saved by oat-calibrate.
+     * @param calibration_file Calibration file path.
+     * @param calibration_key Key that the calibration was saved under.
+     */
+    void loadCalibration(const std::string& calibration_file, 
+                         const std::string& calibration_key = "calibration");
     
     // Accessors
-    void set_camera_matrix(const cv::Matx33d& value) { camera_matrix_ = value; }
-    void set_distortion_coefficients(const cv::Mat& value) { distortion_coefficients_ = value.clone(); }
+    void set_camera_matrix(const cv::Matx33d& value) { 
+        camera_matrix_ = value; 
+        updateModel();
+    }
+    void set_distortion_coefficients(const cv::Mat& value) { 
+        distortion_coefficients_ = value.clone(); 
+        updateModel();
+    }
     
 private:
     
@@ -57,11 +71,16 @@ private:
      */
     cv::Mat filter(cv::Mat& frame);
     
-    cv::Mat temp_matrix_;
     bool calibration_valid_ {false};
+    bool fisheye_ {false};
     cv::Matx33d camera_matrix_ ;
     cv::Mat distortion_coefficients_;
 
+    // Remap tables are built from the first frame and reused
+    oat::UndistortMap undistort_map_;
+    cv::Mat undistorted_frame_;
+    void updateModel(void);
+
 };
 
 #endif	/* UNDISTORTER_H */
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <csignal>
 #include <unordered_map>
+#include <vector>
 #include <boost/program_options.hpp>
 #include <opencv2/core.hpp>
 
@@ -31,7 +32,12 @@
 #include "FrameFilter.h"
 #include "BackgroundSubtractor.h"
 #include "BackgroundSubtractorMOG.h"
+#include "BackgroundSubtractorMedian.h"
+#include "FilterChain.h"
 #include "FrameMasker.h"
+#include "FramePyramid.h"
+#include "FrameThresholder.h"
+#include "Undistorter.h"
 
 namespace po = boost::program_options;
 
@@ -46,7 +52,14 @@ void printUsage(po::options_description options){
               << "TYPE\n"
               << "  bsub: Background subtraction\n"
               << "  mask: Binary mask\n"
-              << "   mog: Mixture of Gaussians background segmentation.\n\n"
+              << "   mog: Mixture of Gaussians background segmentation.\n"
+              << "  median: Temporal median background subtraction.\n"
+              << "  pyramid: Publish 2x, 4x, ... downsampled frames to SINK_l1, "
+              << "SINK_l2, ...\n"
+              << "  threshold: Binary mask, packed at one bit per pixel.\n"
+              << "  undistort: Lens distortion correction using parameters from "
+              << "oat calibrate.\n"
+              << "  chain: Several of the above filters applied in sequence.\n\n"
               << "SOURCE:\n"
               << "  User-supplied name of the memory segment to receive frames "
               << "from (e.g. raw).\n\n"
@@ -61,6 +74,25 @@ void sigHandler(int s) {
     quit = 1;
 }
 
+// Create a filter of the given TYPE. Returns nullptr if TYPE is invalid.
+std::shared_ptr<FrameFilter> createFilter(const char type,
+                                          const std::string& source,
+                                          const std::string& sink,
+                                          const bool invert_mask) {
+
+    switch (type) {
+        case 'a': return std::make_shared<BackgroundSubtractor>(source, sink);
+        case 'b': return std::make_shared<FrameMasker>(source, sink, invert_mask);
+        case 'c': return std::make_shared<BackgroundSubtractorMOG>(source, sink);
+        case 'd': return std::make_shared<Undistorter>(source, sink);
+        case 'e': return std::make_shared<FilterChain>(source, sink);
+        case 'f': return std::make_shared<BackgroundSubtractorMedian>(source, sink);
+        case 'g': return std::make_shared<FramePyramid>(source, sink);
+        case 'h': return std::make_shared<FrameThresholder>(source, sink);
+        default: return nullptr;
+    }
+}
+
 // Processing loop
 void run(const std::shared_ptr<FrameFilter>& frameFilter) {
 
@@ -80,12 +112,18 @@ int main(int argc, char *argv[]) {
     std::string config_key;
     bool config_used = false;
     bool invert_mask = false;
+    int num_workers = 1;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
     type_hash["bsub"] = 'a';
     type_hash["mask"] = 'b';
     type_hash["mog"] = 'c';
+    type_hash["undistort"] = 'd';
+    type_hash["chain"] = 'e';
+    type_hash["median"] = 'f';
+    type_hash["pyramid"] = 'g';
+    type_hash["threshold"] = 'h';
     
     try {
 
@@ -100,6 +138,12 @@ int main(int argc, char *argv[]) {
                 ("config-file,c", po::value<std::string>(&config_file), "Configuration file.")
                 ("config-key,k", po::value<std::string>(&config_key), "Configuration key.")
                 ("invert-mask,m", "If using TYPE=mask, invert the mask before applying")
+                ("workers,w", po::value<int>(&num_workers),
+                "Filter frames on this many threads, each with its own copy of the "
+                "filter. Frames are handed to the threads in turn and published in "
+                "order. Stateful filters (bsub with adaptation, mog, median) keep "
+                "one state per thread, each updated from every N-th frame. "
+                "Not supported by TYPE=pyramid. Defaults to 1.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -189,6 +233,26 @@ int main(int argc, char *argv[]) {
             config_used = true;
         }
 
+        if (num_workers < 1) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("The number of workers must be at least 1.\n");
+            return -1;
+        }
+
+        if (num_workers > 1 && type.compare("pyramid") == 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("TYPE=pyramid publishes several streams per "
+                    "frame and cannot use workers.\n");
+            return -1;
+        }
+
+        if (type.compare("chain") == 0 && !config_used) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("TYPE=chain requires a configuration file "
+                    "that specifies its stages.\n");
+            return -1;
+        }
+
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
         return -1;
@@ -198,36 +262,24 @@ int main(int argc, char *argv[]) {
     }
 
     // Create component
-    std::shared_ptr<FrameFilter> filter;
-    
-    // Refine component type
-    switch (type_hash[type]) {
-        case 'a':
-        {
-            filter = std::make_shared<BackgroundSubtractor>(source, sink);
-            break;
-        }
-        case 'b':
-        {
-            filter = std::make_shared<FrameMasker>(source, sink, invert_mask);
-            if (!config_used)
-                 std::cerr << oat::whoWarn(filter->get_name(), 
-                         "No mask configuration was provided." 
-                         " This filter does nothing but waste CPU cycles.\n");
-            break;
-        }
-        case 'c':
-        {
-            filter = std::make_shared<BackgroundSubtractorMOG>(source, sink);
-            break;
-        }
-        default:
-        {
-            printUsage(visible_options);
-            std::cerr << oat::Error("Invalid TYPE specified.\n");
-            return -1;
-        }
+    std::shared_ptr<FrameFilter> filter = 
+        createFilter(type_hash[type], source, sink, invert_mask);
+
+    if (!filter) {
+        printUsage(visible_options);
+        std::cerr << oat::Error("Invalid TYPE specified.\n");
+        return -1;
     }
+
+    if (!config_used && type_hash[type] == 'b')
+         std::cerr << oat::whoWarn(filter->get_name(), 
+                 "No mask configuration was provided." 
+                 " This filter does nothing but waste CPU cycles.\n");
+
+    if (!config_used && type_hash[type] == 'd')
+         std::cerr << oat::whoWarn(filter->get_name(), 
+                 "No calibration was provided." 
+                 " This filter does nothing but waste CPU cycles.\n");
     
     // The business
     try { 
@@ -235,6 +287,19 @@ int main(int argc, char *argv[]) {
         if (config_used)
             filter->configure(config_file, config_key);
 
+        // Worker copies have no SOURCE or SINK of their own
+        if (num_workers > 1) {
+
+            std::vector<std::shared_ptr<FrameFilter>> workers;
+            for (int i = 0; i < num_workers; i++) {
+                workers.push_back(createFilter(type_hash[type], "", "", invert_mask));
+                if (config_used)
+                    workers.back()->configure(config_file, config_key);
+            }
+
+            filter->set_workers(workers);
+        }
+
         // Tell user
         std::cout << oat::whoMessage(filter->get_name(),
                 "Listening to source " + oat::sourceText(source) + ".\n")
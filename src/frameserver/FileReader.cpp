@@ -30,31 +30,150 @@
 
 FileReader::FileReader(std::string file_name_in, 
         std::string image_sink_name, 
-        const double frames_per_second) :
+        const double frames_per_second,
+        const bool max_rate,
+        const uint32_t start_frame,
+        const uint32_t stop_frame) :
   FrameServer(image_sink_name)
 , file_name(file_name_in)
 , file_reader(file_name_in)
 , use_roi(false)
-, frame_rate_in_hz(frames_per_second) {
+, frame_rate_in_hz(frames_per_second)
+, max_rate(max_rate)
+, start_frame(start_frame)
+, stop_frame(stop_frame)
+, frame_pool(DECODE_BUFFER_SIZE)
+, decoding(false)
+, end_of_file(false) {
 
     // Default config
     configure();
-    tick = clock.now();
+
+    // Instead of pacing frames with a timer, wait on clients when the
+    // sink buffer is full
+    set_sink_blocking(max_rate);
+}
+
+FileReader::~FileReader() {
+
+    decoding = false;
+    slot_freed.notify_all();
+
+    if (decode_thread.joinable())
+        decode_thread.join();
+
+#ifndef NDEBUG
+    std::cout << oat::dbgMessage("Frame pacing: " + pacer.report() + "\n");
+#endif
+}
+
+void FileReader::startDecoding() {
+
+    for (int i = 0; i < DECODE_BUFFER_SIZE; i++)
+        free_slots.push(i);
+
+    // Seek to the first requested frame. Samples are numbered from the
+    // position in the file so that segments of a file can be recombined.
+    // Seeking is approximate for some streams (e.g. with B-frames or a
+    // variable frame rate), so if the decoder does not land exactly on the
+    // requested frame, decode forward to it from the start of the file.
+    if (start_frame > 0) {
+
+        bool exact = file_reader.set(cv::CAP_PROP_POS_FRAMES, start_frame) &&
+            static_cast<int64_t>(file_reader.get(cv::CAP_PROP_POS_FRAMES)) == start_frame;
+
+        if (!exact) {
+
+            file_reader.release();
+            if (!file_reader.open(file_name))
+                throw (std::runtime_error("Unable to reopen " + file_name + "."));
+
+            for (uint32_t i = 0; i < start_frame; i++) {
+                if (!file_reader.grab())
+                    throw (std::runtime_error("Failed to seek to frame " 
+                            + std::to_string(start_frame) + " in " + file_name + "."));
+            }
+        }
+
+        set_current_sample(start_frame);
+    }
+
+    decoding = true;
+    decode_thread = std::thread(&FileReader::decodeAhead, this);
+}
+
+void FileReader::decodeAhead() {
+
+    int slot;
+    uint32_t frame_index = start_frame;
+
+    while (decoding) {
+
+        // Stop at the end of the requested frame range
+        if (stop_frame != 0 && frame_index >= stop_frame) {
+            end_of_file = true;
+            slot_decoded.notify_one();
+            return;
+        }
+
+        // Wait for the consumer to return a matrix to the pool
+        if (!free_slots.pop(slot)) {
+            std::unique_lock<std::mutex> lk(decode_mutex);
+            slot_freed.wait_for(lk, std::chrono::milliseconds(10));
+            continue;
+        }
+
+        // Decode into the recycled matrix. Its buffer is reused as long as
+        // the frame size does not change.
+        if (!file_reader.read(frame_pool[slot])) {
+            end_of_file = true;
+            slot_decoded.notify_one();
+            return;
+        }
+
+        decoded_slots.push(slot);
+        slot_decoded.notify_one();
+        frame_index++;
+    }
 }
 
 void FileReader::grabFrame(cv::Mat& frame) {
-    
-    file_reader >> frame;
-    
-    // Crop if necessary
+
+    // Decoding is deferred until the first grab so that it begins after
+    // configuration
+    if (!decoding)
+        startDecoding();
+
+    int slot;
+    while (!decoded_slots.pop(slot)) {
+
+        // The end of file flag is set after the last frame is pushed, so
+        // check the queue once more before reporting EOF
+        if (end_of_file && !decoded_slots.pop(slot)) {
+            frame.release();
+            return;
+        } else if (end_of_file) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lk(decode_mutex);
+        slot_decoded.wait_for(lk, std::chrono::milliseconds(10));
+    }
+
+    // Crop if necessary. Otherwise just trade buffers with the pool.
     if (use_roi) {
-        frame = frame(region_of_interest);
+        frame_pool[slot](region_of_interest).copyTo(frame);
+    } else {
+        cv::swap(frame, frame_pool[slot]);
     }
-    
-    auto tock = clock.now();
-    std::this_thread::sleep_for(frame_period_in_sec - (tock - tick));
-    
-    tick = clock.now();
+
+    free_slots.push(slot);
+    slot_freed.notify_one();
+
+    if (max_rate)
+        return;
+
+    pacer.wait();
 }
 
 void FileReader::configure() {
@@ -64,7 +183,7 @@ void FileReader::configure() {
 void FileReader::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"frame_rate", "roi"};
+    std::vector<std::string> options {"frame_rate", "roi", "calibration_file"};
 
     // This will throw cpptoml::parse_exception if a file 
     // with invalid TOML is provided
@@ -129,9 +248,6 @@ void FileReader::configure(const std::string& config_file, const std::string& co
 }
 
 void FileReader::calculateFramePeriod() {
-    
-    std::chrono::duration<double> frame_period {1.0 / frame_rate_in_hz};
 
-    // Automatic conversion
-    frame_period_in_sec = frame_period;
+    pacer.set_rate(frame_rate_in_hz);
 }
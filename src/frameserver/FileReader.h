@@ -20,10 +20,18 @@
 #ifndef FILEREADER_H
 #define	FILEREADER_H
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include <boost/lockfree/spsc_queue.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "../../lib/utility/Pacer.h"
+
 #include "FrameServer.h"
 
 class FileReader : public FrameServer {
@@ -31,7 +39,12 @@ public:
     
     FileReader(std::string file_name_in, 
                std::string image_sink_name, 
-               const double frames_per_second = 30);
+               const double frames_per_second = 30,
+               const bool max_rate = false,
+               const uint32_t start_frame = 0,
+               const uint32_t stop_frame = 0);
+
+    ~FileReader();
     
     // Implement Camera interface
     void configure(void); 
@@ -46,14 +59,39 @@ private:
     
     // File read
     cv::VideoCapture file_reader;
+
+    // Serve frames as fast as the sink's clients accept them
+    bool max_rate;
+
+    // Frame range to serve. Frames in [start_frame, stop_frame) are served
+    // and numbered by their index in the file. stop_frame = 0 serves until
+    // the end of the file.
+    const uint32_t start_frame;
+    const uint32_t stop_frame;
+
+    // Decode-ahead. Frames are decoded into a pool of reusable matrices by a
+    // separate thread. Slot indices circulate between the free and decoded
+    // queues so that no matrices are allocated once the pool is warm.
+    static const int DECODE_BUFFER_SIZE {16};
+    std::vector<cv::Mat> frame_pool;
+    boost::lockfree::spsc_queue
+    <int, boost::lockfree::capacity<DECODE_BUFFER_SIZE> > free_slots;
+    boost::lockfree::spsc_queue
+    <int, boost::lockfree::capacity<DECODE_BUFFER_SIZE> > decoded_slots;
+    std::thread decode_thread;
+    std::mutex decode_mutex;
+    std::condition_variable slot_freed, slot_decoded;
+    std::atomic<bool> decoding;
+    std::atomic<bool> end_of_file;
+
+    void startDecoding(void);
+    void decodeAhead(void);
     
     // Should the image be cropped
     bool use_roi;
     
-    // frame generation clock
-    std::chrono::high_resolution_clock clock;
-    std::chrono::duration<double> frame_period_in_sec;
-    std::chrono::high_resolution_clock::time_point tick;
+    // Frame pacing
+    oat::Pacer pacer;
 };
 
 #endif	/* FILEREADER_H */
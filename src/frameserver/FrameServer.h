@@ -21,24 +21,33 @@
 #define	FRAMESERVER_H
 
 #include <atomic>
+#include <memory>
 #include <opencv2/opencv.hpp>
 
 #include "../../lib/shmem/SharedMemoryManager.h"
 #include "../../lib/shmem/BufferedMatServer.h"
+#include "../../lib/utility/UndistortMap.h"
 
 /**
  * Abstract base class to be implemented by any Camera Server within the Simple
  * Tracker project.
- * @param image_sink_name Image SINK name.
+ * @param image_sink_name Image SINK name. If empty, no SINK is created and
+ * frames can only be obtained using acquireFrame(). This allows a server to
+ * aggregate other servers.
  */
 class FrameServer {
 public:
     
     FrameServer(std::string image_sink_name) : 
       name("frameserve[" + image_sink_name + "]")
-    , frame_sink(image_sink_name)
     , undistort_image(false)
-    , current_sample(0) { }
+    , current_sample(0) {
+
+        if (!image_sink_name.empty())
+            frame_sink.reset(new oat::BufferedMatServer(image_sink_name));
+    }
+
+    virtual ~FrameServer() { }
     
     /**
      * Cameras must be able to serve cv::Mat frames.
@@ -46,29 +55,57 @@ public:
      */
     virtual bool serveFrame(void) {
         
-        grabFrame(current_frame);
-        undistortFrame(); // TODO: move to frame filt
+        acquireFrame();
         
         if (!current_frame.empty()) {
             
-            frame_sink.pushMat(current_frame, current_sample);
+            frame_sink->pushMat(current_frame, current_sample);
             current_sample++; // TODO: clock samole management should be handled automatically
             
             return false;
         } else {
             
+            // Publish anything still buffered before signaling EOF
+            frame_sink->flush();
             stop();
             return true;
         }
     };
+
+    /**
+     * Obtain the next frame without publishing it.
+     * @return Frame. Empty at end of stream.
+     */
+    const cv::Mat& acquireFrame(void) {
+
+        grabFrame(current_frame);
+        undistortFrame(); // TODO: move to frame filt
+
+        return current_frame;
+    }
     
     // Cameras allow image undistortion if parameters are provided
     // TODO: This should absolutely be a framefilt component
     void undistortFrame(void) {
         if (undistort_image) {
-            cv::Mat undistorted_frame;
-            cv::undistort(current_frame, undistorted_frame, camera_matrix, distortion_coefficients);
-            current_frame = undistorted_frame;
+
+            // Remap tables are built once, from the first frame
+            if (!undistort_map_valid) {
+                undistort_map.set_model(camera_matrix, distortion_coefficients);
+                undistort_map_valid = true;
+            }
+
+            // Remap into a buffer we own and swap it with the grabbed
+            // frame. Sources that read into current_frame then reuse the
+            // last output buffer, so no frame is allocated in steady state.
+            undistort_map.apply(current_frame, undistorted_frame);
+            cv::swap(current_frame, undistorted_frame);
+
+            // The grabbed frame is only reused as the next output if nothing
+            // else refers to it. Sources may keep it in a pool or map it
+            // from a file.
+            if (!undistorted_frame.u || undistorted_frame.u->refcount > 1)
+                undistorted_frame.release();
         }
     }
  
@@ -82,12 +119,26 @@ public:
     
     // Cameras must be interruptable by the user in a way that ensures shmem
     // is freed
-    void stop(void) { frame_sink.set_running(false); }
+    virtual void stop(void) {
+        if (frame_sink)
+            frame_sink->set_running(false);
+    }
 
 protected:
     
     // Cameras must be able to obtain a cv::Mat from some source (physical camera, file, etc)
     virtual void grabFrame(cv::Mat& frame) = 0;
+
+    // Sources that are not bound to real time (e.g. files) can wait on the
+    // sink's clients instead of dropping frames when they fall behind
+    void set_sink_blocking(bool value) {
+        if (frame_sink)
+            frame_sink->set_blocking(value);
+    }
+
+    // Sources that do not start at the beginning of a stream (e.g. a seek
+    // into a file) can number samples from their absolute position
+    void set_current_sample(uint32_t value) { current_sample = value; }
     
     // Server name
     std::string name;
@@ -102,9 +153,14 @@ protected:
     cv::Mat distortion_coefficients; // TODO: change to Matx
    
 private:
+
+    // Precomputed undistortion map
+    oat::UndistortMap undistort_map;
+    bool undistort_map_valid {false};
+    cv::Mat undistorted_frame;
     
     // cv::Mat server for sending frames to shared memory
-    oat::BufferedMatServer frame_sink;
+    std::unique_ptr<oat::BufferedMatServer> frame_sink;
     
     // Currently acquired frame
     cv::Mat current_frame;
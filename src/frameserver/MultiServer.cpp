@@ -0,0 +1,278 @@
+//******************************************************************************
+//* File:   MultiServer.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <string>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "FileReader.h"
+#include "RawReader.h"
+#include "WebCam.h"
+#ifdef OAT_USE_FLYCAP
+    #include "PGGigECam.h"
+#endif
+
+#include "MultiServer.h"
+
+MultiServer::MultiServer(std::string image_sink_name,
+        const double frames_per_second,
+        const bool max_rate) :
+  FrameServer("")
+, sink_name(image_sink_name)
+, frames_per_second(frames_per_second)
+, max_rate(max_rate)
+, sync_tolerance(0)
+, unsynchronized_sets(0)
+, round(0)
+, sources_finished(0)
+, running(false)
+, sample(0) {
+
+    name = "frameserve[" + image_sink_name + "_*]";
+}
+
+MultiServer::~MultiServer() {
+
+    {
+        std::lock_guard<std::mutex> lk(round_mutex);
+        running = false;
+    }
+    round_started.notify_all();
+
+    for (auto& s : sources) {
+        if (s->thread.joinable())
+            s->thread.join();
+    }
+
+#ifndef NDEBUG
+    std::cout << oat::dbgMessage(std::to_string(unsynchronized_sets)
+              + " unsynchronized frame sets were discarded.\n");
+#endif
+}
+
+void MultiServer::configure() {
+
+    throw (std::runtime_error("TYPE=multi requires a configuration file "
+            "that specifies its sources.\n"));
+}
+
+void MultiServer::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"sources", "sync_tolerance"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        double tolerance_ms = 0.0;
+        oat::config::getValue(this_config, "sync_tolerance", tolerance_ms, 0.0);
+        sync_tolerance = std::chrono::duration<double, std::milli>(tolerance_ms);
+
+        oat::config::Table source_config;
+        if (!oat::config::getTable(this_config, "sources", source_config))
+            throw (std::runtime_error("Required configuration value 'sources' was not specified.\n"));
+
+        // Sources are ordered by name
+        std::vector<std::string> source_names;
+        for (auto it = source_config->begin(); it != source_config->end(); it++)
+            source_names.push_back(it->first);
+        std::sort(source_names.begin(), source_names.end());
+
+        std::vector<std::string> source_options {"type", "file", "index", "config", "sink"};
+
+        for (auto& source_name : source_names) {
+
+            oat::config::Table this_source;
+            oat::config::getTable(source_config, source_name, this_source);
+            oat::config::checkKeys(source_options, this_source);
+
+            std::unique_ptr<Source> source(new Source);
+            source->name = source_name;
+
+            std::string type;
+            oat::config::getValue(this_source, "type", type, true);
+
+            std::string file;
+            int64_t index = 0;
+            oat::config::getValue(this_source, "index", index, (int64_t)0);
+
+            // Sources are created without a SINK. Their frames are published
+            // here.
+            if (type == "file") {
+                oat::config::getValue(this_source, "file", file, true);
+                source->server = std::make_shared<FileReader>(file, "", frames_per_second, max_rate);
+            } else if (type == "raw") {
+                oat::config::getValue(this_source, "file", file, true);
+                source->server = std::make_shared<RawReader>(file, "", frames_per_second, max_rate);
+            } else if (type == "wcam") {
+                source->server = std::make_shared<WebCam>("", index);
+            } else if (type == "gige") {
+#ifdef OAT_USE_FLYCAP
+                source->server = std::make_shared<PGGigECam>("", index);
+#else
+                throw (std::runtime_error("Oat was not compiled with Point-Grey "
+                        "flycapture support, so source type 'gige' is not available.\n"));
+#endif
+            } else {
+                throw (std::runtime_error("Source '" + source_name + "' has invalid type '"
+                        + type + "'. Must be 'file', 'raw', 'wcam' or 'gige'.\n"));
+            }
+
+            // Sources can be configured using another table in the same file
+            std::string source_key;
+            if (oat::config::getValue(this_source, "config", source_key))
+                source->server->configure(config_file, source_key);
+            else
+                source->server->configure();
+
+            std::string source_sink = sink_name + "_" + source_name;
+            oat::config::getValue(this_source, "sink", source_sink);
+            source->sink.reset(new oat::BufferedMatServer(source_sink));
+            source->sink->set_blocking(max_rate);
+
+            sources.push_back(std::move(source));
+        }
+
+        if (sources.empty())
+            throw (std::runtime_error("At least one source must be specified.\n"));
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+
+    startSources();
+}
+
+void MultiServer::startSources() {
+
+    running = true;
+    for (auto& s : sources)
+        s->thread = std::thread(&MultiServer::grabLoop, this, s.get());
+}
+
+void MultiServer::grabLoop(Source* source) {
+
+    uint64_t last_round = 0;
+
+    while (true) {
+
+        {
+            std::unique_lock<std::mutex> lk(round_mutex);
+            round_started.wait(lk, [&] { return !running || round != last_round; });
+            if (!running)
+                return;
+            last_round = round;
+        }
+
+        source->frame = source->server->acquireFrame();
+        source->grab_time = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lk(round_mutex);
+            sources_finished++;
+        }
+        source_finished.notify_one();
+    }
+}
+
+void MultiServer::grabFrame(cv::Mat& frame) {
+
+    // Start a grab on all sources and wait for them to finish
+    {
+        std::lock_guard<std::mutex> lk(round_mutex);
+        sources_finished = 0;
+        round++;
+    }
+    round_started.notify_all();
+
+    {
+        std::unique_lock<std::mutex> lk(round_mutex);
+        source_finished.wait(lk, [&] { return sources_finished == sources.size(); });
+    }
+
+    frame = sources.front()->frame;
+
+    for (auto& s : sources) {
+        if (s->frame.empty()) {
+            frame.release();
+            return;
+        }
+    }
+}
+
+bool MultiServer::serveFrame() {
+
+    cv::Mat frame;
+    grabFrame(frame);
+
+    // Any stream ending ends them all
+    if (frame.empty()) {
+
+        for (auto& s : sources)
+            s->sink->flush();
+
+        stop();
+        return true;
+    }
+
+    if (sync_tolerance.count() > 0) {
+
+        auto first = sources.front()->grab_time;
+        auto last = first;
+        for (auto& s : sources) {
+            first = std::min(first, s->grab_time);
+            last = std::max(last, s->grab_time);
+        }
+
+        // The sample number is used even if the set is discarded so that
+        // downstream components can see the gap
+        if (last - first > sync_tolerance) {
+            unsynchronized_sets++;
+            sample++;
+            return false;
+        }
+    }
+
+    for (auto& s : sources)
+        s->sink->pushMat(s->frame, sample);
+
+    sample++;
+
+    return false;
+}
+
+void MultiServer::stop() {
+
+    for (auto& s : sources)
+        s->sink->set_running(false);
+}
@@ -0,0 +1,108 @@
+//******************************************************************************
+//* File:   MultiServer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef MULTISERVER_H
+#define	MULTISERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "FrameServer.h"
+
+/**
+ * Serve frames from several sources at once. Each source is grabbed by its
+ * own thread. A grab is started on all sources simultaneously, and the
+ * resulting set of frames is published to one SINK per source using a single
+ * sample number. Externally triggered cameras therefore produce one set per
+ * trigger, and free running sources produce one set per grab.
+ */
+class MultiServer : public FrameServer {
+public:
+
+    /**
+     * Multi-source frame server.
+     * @param image_sink_name Base SINK name. Each source publishes to
+     * '<image_sink_name>_<source name>' unless its SINK is specified.
+     * @param frames_per_second Frame rate of file sources.
+     * @param max_rate Serve file sources as fast as the SINKs' clients
+     * accept frames.
+     */
+    MultiServer(std::string image_sink_name,
+                const double frames_per_second = 30,
+                const bool max_rate = false);
+
+    ~MultiServer();
+
+    // Implement Camera interface
+    void configure(void);
+    void configure(const std::string& config_file, const std::string& config_key);
+    bool serveFrame(void) override;
+    void stop(void) override;
+
+protected:
+
+    /**
+     * Grab a set of frames, one from each source.
+     * @param frame Frame from the first source. Empty if any source has
+     * reached the end of its stream.
+     */
+    void grabFrame(cv::Mat& frame);
+
+private:
+
+    std::string sink_name;
+    double frames_per_second;
+    bool max_rate;
+
+    struct Source {
+        std::string name;
+        std::shared_ptr<FrameServer> server;
+        std::unique_ptr<oat::BufferedMatServer> sink;
+        cv::Mat frame;
+        std::chrono::steady_clock::time_point grab_time;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Source>> sources;
+    void startSources(void);
+
+    // Frames whose grab times differ by more than this are not published.
+    // 0 to publish every set.
+    std::chrono::duration<double, std::milli> sync_tolerance;
+    uint64_t unsynchronized_sets;
+
+    // Grab rounds. Each source thread grabs once per round.
+    std::mutex round_mutex;
+    std::condition_variable round_started, source_finished;
+    uint64_t round;
+    size_t sources_finished;
+    std::atomic<bool> running;
+    void grabLoop(Source* source);
+
+    uint32_t sample;
+};
+
+#endif	/* MULTISERVER_H */
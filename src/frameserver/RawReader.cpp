@@ -0,0 +1,202 @@
+//******************************************************************************
+//* File:   RawReader.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "RawReader.h"
+
+namespace bip = boost::interprocess;
+
+RawReader::RawReader(std::string file_name_in,
+        std::string image_sink_name,
+        const double frames_per_second,
+        const bool max_rate,
+        const uint64_t start_sample,
+        const uint64_t stop_sample) :
+  FrameServer(image_sink_name)
+, file_name(file_name_in)
+, frame_rate_in_hz(frames_per_second)
+, frame_data(nullptr)
+, sample_index(nullptr)
+, file_open(false)
+, frame_index(0)
+, end_index(0)
+, start_sample(start_sample)
+, stop_sample(stop_sample)
+, max_rate(max_rate)
+, use_roi(false) {
+
+    // Instead of pacing frames with a timer, wait on clients when the
+    // sink buffer is full
+    set_sink_blocking(max_rate);
+}
+
+RawReader::~RawReader() {
+
+#ifndef NDEBUG
+    std::cout << oat::dbgMessage("Frame pacing: " + pacer.report() + "\n");
+#endif
+}
+
+void RawReader::openFile() {
+
+    file = bip::file_mapping(file_name.c_str(), bip::read_only);
+    region = bip::mapped_region(file, bip::read_only);
+
+    if (region.get_size() < sizeof(oat::RawFrameHeader))
+        throw (std::runtime_error(file_name + " is not a raw frame file."));
+
+    const uint8_t* base = static_cast<const uint8_t*>(region.get_address());
+    std::memcpy(&header, base, sizeof(header));
+
+    if (!header.valid())
+        throw (std::runtime_error(file_name + " is not a raw frame file."));
+
+    uint64_t data_end = header.data_offset + header.count * header.frame_bytes;
+    uint64_t index_end = header.index_offset + header.count * sizeof(uint64_t);
+    if (region.get_size() < data_end ||
+            (header.index_offset != 0 && region.get_size() < index_end)) {
+        throw (std::runtime_error(file_name + " is truncated."));
+    }
+
+    // Frames are read front to back, so let the kernel read ahead
+    region.advise(bip::mapped_region::advice_sequential);
+
+    frame_data = base + header.data_offset;
+    if (header.index_offset != 0)
+        sample_index = reinterpret_cast<const uint64_t*>(base + header.index_offset);
+
+    // Use the recorded frame rate unless one was specified
+    if (frame_rate_in_hz <= 0) {
+        frame_rate_in_hz = header.frame_rate > 0 ? header.frame_rate : 30.0;
+        calculateFramePeriod();
+    }
+
+    end_index = stop_sample != 0 ? findFrame(stop_sample) : header.count;
+    file_open = true;
+
+    seek(start_sample);
+}
+
+uint64_t RawReader::findFrame(const uint64_t sample) const {
+
+    if (!sample_index)
+        return std::min<uint64_t>(sample, header.count);
+
+    return std::lower_bound(sample_index, sample_index + header.count, sample)
+            - sample_index;
+}
+
+void RawReader::seek(const uint64_t sample) {
+
+    frame_index = findFrame(sample);
+}
+
+void RawReader::grabFrame(cv::Mat& frame) {
+
+    // Opened on first grab so that errors are reported after configuration
+    if (!file_open)
+        openFile();
+
+    if (frame_index >= end_index) {
+        frame.release();
+        return;
+    }
+
+    // Wrap the mapped frame. The sink makes the only copy. The mapping is
+    // read only, so the frame must not be modified in place.
+    cv::Mat mapped(header.rows, header.cols, header.type,
+            const_cast<uint8_t*>(frame_data + frame_index * header.frame_bytes));
+
+    frame = use_roi ? mapped(region_of_interest) : mapped;
+
+    set_current_sample(sample_index ? sample_index[frame_index] : frame_index);
+    frame_index++;
+
+    if (max_rate)
+        return;
+
+    pacer.wait();
+}
+
+void RawReader::configure() {
+    calculateFramePeriod();
+}
+
+void RawReader::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"frame_rate", "roi"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Set the frame rate
+        oat::config::getValue(this_config, "frame_rate", frame_rate_in_hz, 0.0);
+        calculateFramePeriod();
+
+        // Set the ROI
+        oat::config::Table roi;
+        if (oat::config::getTable(this_config, "roi", roi)) {
+
+            int64_t val;
+            oat::config::getValue(roi, "x_offset", val, (int64_t)0, true);
+            region_of_interest.x = val;
+            oat::config::getValue(roi, "y_offset", val, (int64_t)0, true);
+            region_of_interest.y = val;
+            oat::config::getValue(roi, "width", val, (int64_t)0, true);
+            region_of_interest.width = val;
+            oat::config::getValue(roi, "height", val, (int64_t)0, true);
+            region_of_interest.height = val;
+            use_roi = true;
+
+        } else {
+            use_roi = false;
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void RawReader::calculateFramePeriod() {
+
+    // Rate taken from the file once it is opened
+    if (frame_rate_in_hz <= 0)
+        return;
+
+    pacer.set_rate(frame_rate_in_hz);
+}
@@ -0,0 +1,105 @@
+//******************************************************************************
+//* File:   RawReader.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef RAWREADER_H
+#define	RAWREADER_H
+
+#include <string>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "../../lib/utility/Pacer.h"
+#include "../../lib/utility/RawFrameFormat.h"
+
+#include "FrameServer.h"
+
+/**
+ * Serve frames from an uncompressed raw frame file (see RawFrameFormat.h).
+ * The file is memory mapped, so frames are published directly from the page
+ * cache without decoding.
+ */
+class RawReader : public FrameServer {
+public:
+
+    /**
+     * Raw frame file server.
+     * @param file_name_in Path to raw frame file.
+     * @param image_sink_name Image SINK name.
+     * @param frames_per_second Serving rate. If 0, the rate stored in the
+     * file is used.
+     * @param max_rate Serve frames as fast as the SINK's clients accept them.
+     * @param start_sample First sample to serve.
+     * @param stop_sample Serve samples before this one. 0 to serve until the
+     * end of the file.
+     */
+    RawReader(std::string file_name_in,
+              std::string image_sink_name,
+              const double frames_per_second = 0,
+              const bool max_rate = false,
+              const uint64_t start_sample = 0,
+              const uint64_t stop_sample = 0);
+
+    ~RawReader();
+
+    // Implement Camera interface
+    void configure(void);
+    void configure(const std::string& config_file, const std::string& config_key);
+    void grabFrame(cv::Mat& frame);
+
+    /**
+     * Move to the first frame with sample number greater than or equal to
+     * the one requested.
+     * @param sample Sample number to seek to.
+     */
+    void seek(const uint64_t sample);
+
+private:
+
+    std::string file_name;
+    double frame_rate_in_hz;
+    void calculateFramePeriod(void);
+
+    // Memory mapped file
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+    oat::RawFrameHeader header;
+    const uint8_t* frame_data;
+    const uint64_t* sample_index;
+    bool file_open;
+    void openFile(void);
+
+    // Position in file
+    uint64_t frame_index;
+    uint64_t end_index;
+    const uint64_t start_sample;
+    const uint64_t stop_sample;
+    uint64_t findFrame(const uint64_t sample) const;
+
+    // Serve frames as fast as the sink's clients accept them
+    bool max_rate;
+
+    // Should the image be cropped
+    bool use_roi;
+
+    // Frame pacing
+    oat::Pacer pacer;
+};
+
+#endif	/* RAWREADER_H */
@@ -0,0 +1,344 @@
+//******************************************************************************
+//* File:   SyntheticSource.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "SyntheticSource.h"
+
+SyntheticSource::SyntheticSource(std::string image_sink_name,
+        const double frames_per_second,
+        const bool max_rate,
+        const uint32_t stop_sample) :
+  FrameServer(image_sink_name)
+, sink_name(image_sink_name)
+, frame_rate_in_hz(frames_per_second)
+, frame_size(640, 480)
+, background(50)
+, noise(10.0)
+, jitter_ms(0.0)
+, drop_probability(0.0)
+, burst_probability(0.0)
+, burst_delay_ms(0.0)
+, seed(1)
+, uniform(0.0, 1.0)
+, turn(0.0, 1.0)
+, sample(0)
+, stop_sample(stop_sample)
+, max_rate(max_rate) {
+
+    // Instead of pacing frames with a timer, wait on clients when the
+    // sink buffer is full
+    set_sink_blocking(max_rate);
+    pacer.set_policy(oat::Pacer::LatePolicy::SKIP);
+}
+
+SyntheticSource::~SyntheticSource() {
+
+#ifndef NDEBUG
+    std::cout << oat::dbgMessage("Frame pacing: " + pacer.report() + "\n");
+#endif
+}
+
+void SyntheticSource::configure() {
+
+    calculateFramePeriod();
+    addDefaultBlob();
+    placeBlobs();
+    createTruthSinks();
+}
+
+void SyntheticSource::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"frame_rate",
+                                      "width",
+                                      "height",
+                                      "background",
+                                      "noise",
+                                      "seed",
+                                      "jitter",
+                                      "drop_probability",
+                                      "burst_probability",
+                                      "burst_delay",
+                                      "blobs"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Set the frame rate
+        oat::config::getValue(this_config, "frame_rate", frame_rate_in_hz, 0.0);
+        calculateFramePeriod();
+
+        // Frame geometry and appearance
+        int64_t val;
+        if (oat::config::getValue(this_config, "width", val, (int64_t)1))
+            frame_size.width = val;
+        if (oat::config::getValue(this_config, "height", val, (int64_t)1))
+            frame_size.height = val;
+        if (oat::config::getValue(this_config, "background", val, (int64_t)0, (int64_t)255))
+            background = val;
+        oat::config::getValue(this_config, "noise", noise, 0.0);
+
+        if (oat::config::getValue(this_config, "seed", val, (int64_t)0))
+            seed = val;
+
+        // Timing faults
+        oat::config::getValue(this_config, "jitter", jitter_ms, 0.0);
+        oat::config::getValue(this_config, "drop_probability", drop_probability, 0.0, 1.0);
+        oat::config::getValue(this_config, "burst_probability", burst_probability, 0.0, 1.0);
+        oat::config::getValue(this_config, "burst_delay", burst_delay_ms, 0.0);
+
+        if (drop_probability >= 1.0)
+            throw (std::runtime_error("drop_probability must be less than 1.\n"));
+
+        // Blobs
+        oat::config::Table blob_config;
+        if (oat::config::getTable(this_config, "blobs", blob_config)) {
+
+            std::vector<std::string> blob_options {"color", "radius", "speed", "sink"};
+
+            auto it = blob_config->begin();
+            while (it != blob_config->end()) {
+
+                oat::config::Table this_blob;
+                oat::config::getTable(blob_config, it->first, this_blob);
+                oat::config::checkKeys(blob_options, this_blob);
+
+                Blob blob;
+                blob.name = it->first;
+
+                oat::config::Array color;
+                oat::config::getArray(this_blob, "color", color, 3, true);
+                auto rgb = color->array_of<int64_t>();
+                blob.color = cv::Scalar(rgb[2]->get(), rgb[1]->get(), rgb[0]->get());
+
+                oat::config::getValue(this_blob, "radius", val, (int64_t)1, true);
+                blob.radius = val;
+
+                blob.speed = 0.0;
+                oat::config::getValue(this_blob, "speed", blob.speed, 0.0);
+
+                blob.sink_name = sink_name + "_" + blob.name;
+                oat::config::getValue(this_blob, "sink", blob.sink_name);
+
+                blobs.push_back(blob);
+                it++;
+            }
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+
+    addDefaultBlob();
+    placeBlobs();
+    createTruthSinks();
+}
+
+void SyntheticSource::grabFrame(cv::Mat& frame) {
+
+    if (stop_sample != 0 && sample >= stop_sample) {
+        frame.release();
+        return;
+    }
+
+    moveBlobs();
+
+    // A dropped frame is simulated, but never published, leaving a gap in
+    // the sample numbers
+    while (drop_probability > 0 && uniform(fault_generator) < drop_probability) {
+
+        waitForNextFrame();
+
+        if (stop_sample != 0 && sample >= stop_sample) {
+            frame.release();
+            return;
+        }
+
+        moveBlobs();
+    }
+
+    render();
+    frame = canvas;
+
+    set_current_sample(sample);
+    publishTruth();
+
+    waitForNextFrame();
+}
+
+void SyntheticSource::calculateFramePeriod() {
+
+    period_in_sec = 1.0 / frame_rate_in_hz;
+    pacer.set_rate(frame_rate_in_hz);
+}
+
+void SyntheticSource::addDefaultBlob() {
+
+    if (!blobs.empty())
+        return;
+
+    Blob blob;
+    blob.name = "truth";
+    blob.sink_name = sink_name + "_truth";
+    blob.color = cv::Scalar(0, 0, 255);
+    blob.radius = 15;
+    blob.speed = 150.0;
+    blobs.push_back(blob);
+}
+
+void SyntheticSource::placeBlobs() {
+
+    generator.seed(seed);
+    fault_generator.seed(seed + 1);
+    noise_rng = cv::RNG(seed);
+
+    for (auto& b : blobs) {
+
+        if (2 * b.radius >= frame_size.width || 2 * b.radius >= frame_size.height)
+            throw (std::runtime_error("Blob '" + b.name + "' does not fit in the frame.\n"));
+
+        b.position.x = b.radius + uniform(generator) * (frame_size.width - 2 * b.radius);
+        b.position.y = b.radius + uniform(generator) * (frame_size.height - 2 * b.radius);
+        b.heading = 2.0 * CV_PI * uniform(generator);
+        b.velocity = b.speed * cv::Point2d(std::cos(b.heading), std::sin(b.heading));
+    }
+}
+
+void SyntheticSource::moveBlobs() {
+
+    const double dt = period_in_sec;
+    const double turn_scale = TURN_DIFFUSION * std::sqrt(dt);
+
+    for (auto& b : blobs) {
+
+        // Heading performs a random walk so that paths are smooth but
+        // unpredictable
+        b.heading += turn_scale * turn(generator);
+        b.velocity = b.speed * cv::Point2d(std::cos(b.heading), std::sin(b.heading));
+        b.position += dt * b.velocity;
+
+        // Reflect off of the frame edges
+        const double x_max = frame_size.width - b.radius;
+        const double y_max = frame_size.height - b.radius;
+
+        if (b.position.x < b.radius || b.position.x > x_max) {
+            b.position.x = b.position.x < b.radius ?
+                    2 * b.radius - b.position.x : 2 * x_max - b.position.x;
+            b.heading = CV_PI - b.heading;
+        }
+
+        if (b.position.y < b.radius || b.position.y > y_max) {
+            b.position.y = b.position.y < b.radius ?
+                    2 * b.radius - b.position.y : 2 * y_max - b.position.y;
+            b.heading = -b.heading;
+        }
+
+        b.velocity = b.speed * cv::Point2d(std::cos(b.heading), std::sin(b.heading));
+    }
+}
+
+void SyntheticSource::createTruthSinks() {
+
+    truth_sinks.clear();
+    for (auto& b : blobs) {
+        truth_sinks.push_back(std::unique_ptr<oat::BufferedSMServer<oat::Position2D>>(
+                new oat::BufferedSMServer<oat::Position2D>(b.sink_name)));
+    }
+}
+
+void SyntheticSource::publishTruth() {
+
+    for (size_t i = 0; i < blobs.size(); i++) {
+
+        oat::Position2D pos(blobs[i].name);
+        pos.position_valid = true;
+        pos.position = blobs[i].position;
+        pos.velocity_valid = true;
+        pos.velocity = blobs[i].velocity;
+
+        truth_sinks[i]->pushObject(pos, sample);
+    }
+}
+
+void SyntheticSource::render() {
+
+    canvas.create(frame_size, CV_8UC3);
+
+    if (noise > 0) {
+        noise_rng.fill(canvas, cv::RNG::NORMAL,
+                cv::Scalar::all(background), cv::Scalar::all(noise));
+    } else {
+        canvas.setTo(cv::Scalar::all(background));
+    }
+
+    // Blobs are drawn with 4 fractional bits so that they are centered on
+    // their published, subpixel, positions
+    const int shift = 4;
+    const double one = 1 << shift;
+
+    for (auto& b : blobs) {
+        const cv::Point center(cvRound(b.position.x * one), cvRound(b.position.y * one));
+        cv::circle(canvas, center, b.radius << shift, b.color, -1, cv::LINE_AA, shift);
+    }
+}
+
+void SyntheticSource::waitForNextFrame() {
+
+    sample++;
+
+    if (max_rate)
+        return;
+
+    // Injected timing faults. Jitter delays a frame without moving the
+    // schedule. A stall long enough to miss deadlines drops those samples.
+    if (burst_probability > 0 && uniform(fault_generator) < burst_probability) {
+        std::chrono::duration<double, std::milli> stall {burst_delay_ms};
+        std::this_thread::sleep_for(stall);
+    }
+
+    uint64_t skipped = pacer.wait();
+    for (uint64_t i = 0; i < skipped; i++) {
+        moveBlobs();
+        sample++;
+    }
+
+    if (jitter_ms > 0) {
+        std::chrono::duration<double, std::milli> jitter {jitter_ms * uniform(fault_generator)};
+        std::this_thread::sleep_for(jitter);
+    }
+}
@@ -0,0 +1,131 @@
+//******************************************************************************
+//* File:   SyntheticSource.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef SYNTHETICSOURCE_H
+#define	SYNTHETICSOURCE_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmem/BufferedSMServer.h"
+#include "../../lib/utility/Pacer.h"
+
+#include "FrameServer.h"
+
+/**
+ * Serve synthetic frames containing colored blobs that move over a noisy
+ * background. The true position of each blob is published to its own
+ * position SINK using the same sample number as the frame it was drawn in.
+ * Timing faults (jitter, dropped frames and stalls) can be injected to test
+ * downstream components.
+ */
+class SyntheticSource : public FrameServer {
+public:
+
+    /**
+     * Synthetic frame server.
+     * @param image_sink_name Image SINK name. Ground truth SINKs are named
+     * relative to this one unless otherwise specified.
+     * @param frames_per_second Frame rate.
+     * @param max_rate Serve frames as fast as the SINK's clients accept them.
+     * @param stop_sample Number of samples to generate. 0 to run until
+     * interrupted.
+     */
+    SyntheticSource(std::string image_sink_name,
+                    const double frames_per_second = 30,
+                    const bool max_rate = false,
+                    const uint32_t stop_sample = 0);
+
+    ~SyntheticSource();
+
+    // Implement Camera interface
+    void configure(void);
+    void configure(const std::string& config_file, const std::string& config_key);
+    void grabFrame(cv::Mat& frame);
+
+private:
+
+    std::string sink_name;
+    double frame_rate_in_hz;
+    double period_in_sec;
+    void calculateFramePeriod(void);
+
+    // Simulated object
+    struct Blob {
+        std::string name;
+        std::string sink_name;
+        cv::Scalar color;
+        int radius;
+        double speed;       // pixels per second
+        double heading;     // radians
+        cv::Point2d position;
+        cv::Point2d velocity;
+    };
+
+    std::vector<Blob> blobs;
+    static constexpr double TURN_DIFFUSION {2.0}; // radians / sqrt(second)
+    void addDefaultBlob(void);
+    void placeBlobs(void);
+    void moveBlobs(void);
+
+    // Ground truth SINKs, one per blob
+    std::vector<std::unique_ptr<oat::BufferedSMServer<oat::Position2D>>> truth_sinks;
+    void createTruthSinks(void);
+    void publishTruth(void);
+
+    // Rendering
+    cv::Size frame_size;
+    int background;
+    double noise;
+    cv::RNG noise_rng;
+    cv::Mat canvas;
+    void render(void);
+
+    // Injected timing faults
+    double jitter_ms;
+    double drop_probability;
+    double burst_probability;
+    double burst_delay_ms;
+
+    // Random state. Seeded so runs are repeatable. Faults use a separate
+    // generator so that blob paths do not depend on the fault settings.
+    uint64_t seed;
+    std::mt19937 generator;
+    std::mt19937 fault_generator;
+    std::uniform_real_distribution<double> uniform;
+    std::normal_distribution<double> turn;
+
+    // Sample being generated
+    uint32_t sample;
+    const uint32_t stop_sample;
+
+    // Serve frames as fast as the sink's clients accept them
+    bool max_rate;
+
+    // Frame pacing. Like a free running camera, periods that are missed
+    // (e.g. due to an injected stall) are dropped rather than served late.
+    oat::Pacer pacer;
+    void waitForNextFrame(void);
+};
+
+#endif	/* SYNTHETICSOURCE_H */
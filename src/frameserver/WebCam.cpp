@@ -26,9 +26,9 @@
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/make_unique.h"
 
-WebCam::WebCam(std::string frame_sink_name) :
+WebCam::WebCam(std::string frame_sink_name, const size_t index) :
   FrameServer(frame_sink_name)
-, index(0)
+, index(index)
 , cv_camera(std::make_unique<cv::VideoCapture>(index)){ }
 
 void WebCam::grabFrame(cv::Mat& frame) {
@@ -28,7 +28,7 @@
 
 class WebCam : public FrameServer {
 public:
-    WebCam(std::string frame_sink_name);
+    WebCam(std::string frame_sink_name, const size_t index = 0);
 
     // Implement Camera interface
     void configure(void); 
@@ -28,6 +28,9 @@
 
 #include "FrameServer.h"
 #include "FileReader.h"
+#include "MultiServer.h"
+#include "RawReader.h"
+#include "SyntheticSource.h"
 #include "WebCam.h"
 #ifdef OAT_USE_FLYCAP
     #include "PGGigECam.h"
@@ -62,7 +65,14 @@ void printUsage(po::options_description options) {
               << "TYPE:\n"
               << "  wcam: Onboard or USB webcam.\n"
               << "  gige: Point Grey GigE camera.\n"
-              << "  file: Video from file (*.mpg, *.avi, etc.).\n\n"
+              << "  file: Video from file (*.mpg, *.avi, etc.).\n"
+              << "   raw: Uncompressed frames from a raw frame file (*.raw) written by "
+              << "oat record.\n"
+              << " synth: Synthetic frames containing moving blobs. True blob positions\n"
+              << "        are published to position SINKs.\n"
+              << " multi: Several sources grabbed in parallel. Each source is published\n"
+              << "        to its own SINK and frames grabbed together share a sample\n"
+              << "        number. Sources are specified in the configuration file.\n\n"
               << "SINK:\n"
               << "  User-supplied name of the memory segment to publish frames "
               << "to (e.g. raw).\n\n"
@@ -77,6 +87,10 @@ int main(int argc, char *argv[]) {
     std::string type;
     std::string video_file;
     double frames_per_second = 30;
+    bool fps_specified = false;
+    bool max_rate = false;
+    uint32_t start_frame = 0;
+    uint32_t stop_frame = 0;
     size_t index = 0;
     std::string config_file;
     std::string config_key;
@@ -87,6 +101,9 @@ int main(int argc, char *argv[]) {
     type_hash["wcam"] = 'a';
     type_hash["gige"] = 'b';
     type_hash["file"] = 'c';
+    type_hash["raw"] = 'd';
+    type_hash["synth"] = 'e';
+    type_hash["multi"] = 'f';
 
     try {
 
@@ -101,9 +118,20 @@ int main(int argc, char *argv[]) {
                 ("index,i", po::value<size_t>(&index),
                 "Index of camera to capture images from.")
                 ("video-file,f", po::value<std::string>(&video_file),
-                "Path to video file if \'file\' is selected as the server TYPE.")
+                "Path to video file if \'file\' or \'raw\' is selected as the server TYPE.")
                 ("fps,r", po::value<double>(&frames_per_second),
                 "Frames per second. Overriden by information in configuration file if provided.")
+                ("max-rate,m", "If TYPE=file, raw, synth or multi, serve frames as fast as the SINK's clients "
+                "can accept them instead of at the frame rate.")
+                ("start-frame", po::value<uint32_t>(&start_frame),
+                "If TYPE=file or raw, index of the first frame to serve. Samples are "
+                "numbered from this index. For raw files that record sample numbers, "
+                "this is the first sample number to serve. If a video cannot seek "
+                "exactly to this frame, it is decoded from the start of the file up to it.")
+                ("stop-frame", po::value<uint32_t>(&stop_frame),
+                "If TYPE=file or raw, index one past the last frame to serve. If not "
+                "specified, frames are served until the end of the file. If TYPE=synth, "
+                "the number of samples to generate.")
                 ("config-file,c", po::value<std::string>(&config_file), "Configuration file.")
                 ("config-key,k", po::value<std::string>(&config_key), "Configuration key.")
                 ;
@@ -170,12 +198,49 @@ int main(int argc, char *argv[]) {
             config_used = true;
         }
 
-        if (type.compare("file") == 0 && !variable_map.count("video-file")) {
+        fps_specified = variable_map.count("fps") > 0;
+
+        bool from_file = type.compare("file") == 0 || type.compare("raw") == 0;
+        bool synthetic = type.compare("synth") == 0;
+        bool multi = type.compare("multi") == 0;
+
+        if (multi && !config_used) {
+            printUsage(visible_options);
+            std::cout << "Error: when TYPE=multi, a configuration file specifying "
+                      << "the sources must be provided. Exiting.\n";
+            return -1;
+        }
+
+        if (from_file && !variable_map.count("video-file")) {
+            printUsage(visible_options);
+            std::cout << "Error: when TYPE=file or raw, a video-file path must be specified. Exiting.\n";
+            return -1;
+        }
+
+        if ((variable_map.count("start-frame") && !from_file) ||
+                (variable_map.count("stop-frame") && !from_file && !synthetic)) {
+            std::cerr << oat::Warn("A frame range was specified, but this is the"
+                      " wrong server TYPE for that option.\n")
+                      << oat::Warn("Frame range was ignored.\n");
+        }
+
+        if (variable_map.count("stop-frame") && stop_frame <= start_frame) {
             printUsage(visible_options);
-            std::cout << "Error: when TYPE=file, a video-file path must be specified. Exiting.\n";
+            std::cout << "Error: stop-frame must be greater than start-frame. Exiting.\n";
             return -1;
         }
 
+        if (variable_map.count("max-rate")) {
+
+            if (!from_file && !synthetic && !multi) {
+                std::cerr << oat::Warn("Max-rate specified, but this is the"
+                          " wrong server TYPE for that option.\n")
+                          << oat::Warn("Max-rate option was ignored.\n");
+            } else {
+                max_rate = true;
+            }
+        }
+
     } catch (std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -208,7 +273,27 @@ int main(int argc, char *argv[]) {
         }
         case 'c':
         {
-            server = std::make_shared<FileReader>(video_file, sink, frames_per_second);
+            server = std::make_shared<FileReader>(video_file, sink, 
+                    frames_per_second, max_rate, start_frame, stop_frame);
+            break;
+        }
+        case 'd':
+        {
+            // Unless told otherwise, serve at the recorded rate
+            server = std::make_shared<RawReader>(video_file, sink, 
+                    fps_specified ? frames_per_second : 0, 
+                    max_rate, start_frame, stop_frame);
+            break;
+        }
+        case 'e':
+        {
+            server = std::make_shared<SyntheticSource>(sink, 
+                    frames_per_second, max_rate, stop_frame);
+            break;
+        }
+        case 'f':
+        {
+            server = std::make_shared<MultiServer>(sink, frames_per_second, max_rate);
             break;
         }
         default:
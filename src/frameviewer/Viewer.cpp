@@ -27,6 +27,7 @@
 
 #include "../../lib/shmem/MatClient.h"
 #include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/PackedMask.h"
 
 #include "Viewer.h"
 
@@ -36,7 +37,7 @@ using namespace boost::interprocess;
 Viewer::Viewer(const std::string& frame_source_name,
                const std::string& snapshot_path) :
   name("viewer[" + frame_source_name + "]")
-, frame_source(frame_source_name)
+, frame_source(frame_source_name, true) // Frames are only displayed, never modified
 , snapshot_path_(snapshot_path)  {
 
     // Initialize GUI update timers
@@ -96,6 +97,12 @@ bool Viewer::showImage(const std::string title) {
 
             try {
 
+                if (frame_source.get_current_packed_width() > 0) {
+                    oat::packed::unpack(current_frame, 
+                            frame_source.get_current_packed_width(), unpacked_frame);
+                    current_frame = unpacked_frame;
+                }
+
                 cv::imshow(title, current_frame);
                 tock = Clock::now();
 
@@ -56,6 +56,9 @@ private:
     // Image data
     cv::Mat current_frame;
 
+    // Bit packed masks are expanded to one byte per pixel for display
+    cv::Mat unpacked_frame;
+
     // Frame SOURCE to get frames to display
     oat::MatClient frame_source;
     
@@ -0,0 +1,100 @@
+//******************************************************************************
+//* File:   BinaryDetector.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <string>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/PackedMask.h"
+
+#include "BinaryDetector.h"
+
+BinaryDetector::BinaryDetector(const std::string& image_source_name, const std::string& position_sink_name) :
+  PositionDetector(image_source_name, position_sink_name) { }
+
+void BinaryDetector::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"min_area", "max_area"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        oat::config::getValue(this_config, "min_area", min_object_area, 0.0);
+        oat::config::getValue(this_config, "max_area", max_object_area, 0.0);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+oat::Position2D BinaryDetector::detectPosition(cv::Mat& frame) {
+
+    double m00, m10, m01;
+
+    if (current_packed_width() > 0) {
+
+        // One popcount per 64 pixels rather than one test per pixel
+        oat::packed::Moments m = oat::packed::moments(frame);
+        m00 = m.m00;
+        m10 = m.m10;
+        m01 = m.m01;
+
+    } else {
+
+        // Any non-zero pixel is set
+        const cv::Mat* mask = &frame;
+        if (frame.channels() > 1) {
+            cv::cvtColor(frame, gray_frame, cv::COLOR_BGR2GRAY);
+            mask = &gray_frame;
+        }
+
+        cv::Moments m = cv::moments(*mask, true);
+        m00 = m.m00;
+        m10 = m.m10;
+        m01 = m.m01;
+    }
+
+    oat::Position2D position;
+    position.position_valid = m00 > 0 && 
+                              m00 >= min_object_area &&
+                              (max_object_area <= 0 || m00 <= max_object_area);
+
+    if (position.position_valid) {
+        position.position.x = m10 / m00;
+        position.position.y = m01 / m00;
+    }
+
+    return position;
+}
@@ -0,0 +1,62 @@
+//******************************************************************************
+//* File:   BinaryDetector.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef BINARYDETECTOR_H
+#define	BINARYDETECTOR_H
+
+#include "PositionDetector.h"
+
+/**
+ * Binary mask object position detector. Frames are binary masks, e.g. from
+ * framefilt threshold, and the object position is the centroid of the set
+ * pixels. Bit packed masks are processed without unpacking.
+ */
+class BinaryDetector : public PositionDetector {
+public:
+
+    /**
+     * Binary mask object position detector.
+     * @param image_source_name Image SOURCE name
+     * @param position_sink_name Position SINK name
+     */
+    BinaryDetector(const std::string& image_source_name, const std::string& position_sink_name);
+
+    /**
+     * Find the centroid of the set pixels in a mask.
+     * @param frame mask to look for object in.
+     * @return detected object position.
+     */
+    oat::Position2D detectPosition(cv::Mat& frame);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+
+protected:
+
+    bool accepts_packed_masks(void) const override { return true; }
+
+private:
+
+    // Object is only reported if the number of set pixels is in this range
+    double min_object_area {0.0};
+    double max_object_area {0.0}; // 0 for no maximum
+
+    cv::Mat gray_frame;
+};
+
+#endif	/* BINARYDETECTOR_H */
@@ -0,0 +1,252 @@
+//******************************************************************************
+//* File:   BlobLabeler.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "BlobLabeler.h"
+
+void BlobLabeler::Stats::add(const Run& run) {
+
+    const int64_t len = run.end - run.start;
+
+    if (area == 0) {
+        x0 = run.start;
+        x1 = run.end;
+        y0 = y1 = run.row;
+    } else {
+        x0 = std::min(x0, run.start);
+        x1 = std::max(x1, run.end);
+        y1 = run.row;
+    }
+
+    // Sum of start..end-1. One of the two factors is always even.
+    area += len;
+    sum_x += (run.start + run.end - 1) * len / 2;
+    sum_y += run.row * len;
+}
+
+void BlobLabeler::Stats::merge(const Stats& other) {
+
+    if (other.area == 0)
+        return;
+
+    if (area == 0) {
+        *this = other;
+        return;
+    }
+
+    area += other.area;
+    sum_x += other.sum_x;
+    sum_y += other.sum_y;
+    x0 = std::min(x0, other.x0);
+    y0 = std::min(y0, other.y0);
+    x1 = std::max(x1, other.x1);
+    y1 = std::max(y1, other.y1);
+}
+
+int BlobLabeler::find(std::vector<int>& parent, int i) {
+
+    // Path halving
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void BlobLabeler::unite(std::vector<int>& parent, int a, int b) {
+
+    a = find(parent, a);
+    b = find(parent, b);
+
+    // Linking to the lower index keeps every parent below its child, which
+    // lets the forest be flattened in one forward pass
+    if (a < b)
+        parent[b] = a;
+    else if (b < a)
+        parent[a] = b;
+}
+
+template <typename Unite>
+void BlobLabeler::joinRows(const Run* above, const Run* above_end,
+                           const Run* below, const Run* below_end, Unite unite) {
+
+    // Runs in both rows are sorted, so they are merged like sorted lists.
+    // Diagonal neighbors are connected, so runs touch if they overlap after
+    // extending either one by a pixel.
+    for (; below != below_end; below++) {
+
+        while (above != above_end && above->end < below->start)
+            above++;
+
+        for (const Run* a = above; a != above_end && a->start <= below->end; a++)
+            unite(a, below);
+    }
+}
+
+void BlobLabeler::labelBand(const cv::Mat& mask, Band& band) {
+
+    band.runs.clear();
+    band.parent.clear();
+    band.first_row_end = 0;
+    band.last_row_begin = 0;
+
+    const int cols = mask.cols;
+    size_t above_begin = 0, above_end = 0;
+
+    for (int r = band.rows.start; r < band.rows.end; r++) {
+
+        const uchar* p = mask.ptr<uchar>(r);
+        const size_t row_begin = band.runs.size();
+
+        int c = 0;
+        while (c < cols) {
+
+            // Background is skipped a word at a time
+            while (c + 8 <= cols) {
+                uint64_t word;
+                std::memcpy(&word, p + c, sizeof(word));
+                if (word != 0)
+                    break;
+                c += 8;
+            }
+            while (c < cols && !p[c])
+                c++;
+            if (c == cols)
+                break;
+
+            const int start = c;
+            while (c < cols && p[c])
+                c++;
+
+            band.parent.push_back(band.runs.size());
+            band.runs.push_back({r, start, c});
+        }
+
+        const Run* runs = band.runs.data();
+        joinRows(runs + above_begin, runs + above_end,
+                 runs + row_begin, runs + band.runs.size(),
+                 [&band, runs](const Run* a, const Run* b) {
+                     unite(band.parent, a - runs, b - runs);
+                 });
+
+        if (r == band.rows.start)
+            band.first_row_end = band.runs.size();
+
+        above_begin = row_begin;
+        above_end = band.runs.size();
+    }
+
+    band.last_row_begin = above_begin;
+
+    // Parents precede their children, so after this pass every run points
+    // directly at its root. Roots are numbered in order of appearance.
+    const size_t n = band.runs.size();
+    band.run_label.resize(n);
+
+    int num_labels = 0;
+    for (size_t i = 0; i < n; i++) {
+        const int p = band.parent[band.parent[i]];
+        band.parent[i] = p;
+        band.run_label[i] = (p == static_cast<int>(i)) ? num_labels++ : band.run_label[p];
+    }
+
+    band.stats.assign(num_labels, Stats());
+    for (size_t i = 0; i < n; i++)
+        band.stats[band.run_label[i]].add(band.runs[i]);
+}
+
+void BlobLabeler::BandBody::operator()(const cv::Range& range) const {
+
+    for (int i = range.start; i < range.end; i++)
+        labelBand(mask_, bands_[i]);
+}
+
+const std::vector<Blob>& BlobLabeler::label(const cv::Mat& mask) {
+
+    CV_Assert(mask.type() == CV_8UC1);
+
+    int n = std::min(cv::getNumThreads(), mask.rows / MIN_BAND_ROWS);
+    n = std::max(n, 1);
+
+    bands.resize(n);
+    for (int i = 0; i < n; i++)
+        bands[i].rows = cv::Range(i * mask.rows / n, (i + 1) * mask.rows / n);
+
+    if (n > 1)
+        cv::parallel_for_(cv::Range(0, n), BandBody(mask, bands), n);
+    else
+        labelBand(mask, bands[0]);
+
+    // Join components that meet at the seams between bands
+    int num_labels = 0;
+    for (auto& b : bands) {
+        b.label_offset = num_labels;
+        num_labels += b.stats.size();
+    }
+
+    parent.resize(num_labels);
+    for (int i = 0; i < num_labels; i++)
+        parent[i] = i;
+
+    for (int i = 1; i < n; i++) {
+
+        const Band& above = bands[i - 1];
+        const Band& below = bands[i];
+        const Run* above_runs = above.runs.data();
+        const Run* below_runs = below.runs.data();
+
+        joinRows(above_runs + above.last_row_begin, above_runs + above.runs.size(),
+                 below_runs, below_runs + below.first_row_end,
+                 [&](const Run* a, const Run* b) {
+                     unite(parent,
+                           above.label_offset + above.run_label[a - above_runs],
+                           below.label_offset + below.run_label[b - below_runs]);
+                 });
+    }
+
+    // Sum each band's share of a component. Parents precede their children
+    // here too, so blob indices can be assigned in one forward pass.
+    blob_index.resize(num_labels);
+    int num_blobs = 0;
+    for (int i = 0; i < num_labels; i++) {
+        const int p = parent[parent[i]];
+        parent[i] = p;
+        blob_index[i] = (p == i) ? num_blobs++ : blob_index[p];
+    }
+
+    merged.assign(num_blobs, Stats());
+    for (const auto& b : bands) {
+        for (size_t j = 0; j < b.stats.size(); j++)
+            merged[blob_index[b.label_offset + j]].merge(b.stats[j]);
+    }
+
+    blobs.resize(num_blobs);
+    for (int i = 0; i < num_blobs; i++) {
+        const Stats& s = merged[i];
+        blobs[i].m00 = s.area;
+        blobs[i].m10 = s.sum_x;
+        blobs[i].m01 = s.sum_y;
+        blobs[i].bounding_box = cv::Rect(s.x0, s.y0, s.x1 - s.x0, s.y1 - s.y0 + 1);
+    }
+
+    return blobs;
+}
@@ -0,0 +1,123 @@
+//******************************************************************************
+//* File:   BlobLabeler.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef BLOBLABELER_H
+#define	BLOBLABELER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+
+/**
+ * An 8-connected component of a binary mask.
+ */
+struct Blob {
+
+    // Raw spatial moments of the component's pixels
+    double m00 {0.0}, m10 {0.0}, m01 {0.0};
+    cv::Rect bounding_box;
+
+    double area(void) const { return m00; }
+    cv::Point2d centroid(void) const { return cv::Point2d(m10 / m00, m01 / m00); }
+};
+
+/**
+ * Labels the 8-connected components of a binary mask in a single pass and
+ * accumulates the area, centroid and bounding box of each one as it goes.
+ * Each row is split into runs of foreground pixels, and runs that touch a run
+ * in the row above are merged using union-find. The mask is split into bands
+ * of rows that are labeled in parallel and then joined at their seams. The
+ * mask is not modified, and all working memory is reused between frames.
+ */
+class BlobLabeler {
+public:
+
+    /**
+     * Find the blobs in a mask.
+     * @param mask 8-bit, single channel mask. Non-zero pixels are foreground.
+     * @return Blobs in the mask, in no particular order. Valid until the next
+     * call.
+     */
+    const std::vector<Blob>& label(const cv::Mat& mask);
+
+private:
+
+    // Fewest rows worth giving their own thread
+    static constexpr int MIN_BAND_ROWS {32};
+
+    // Foreground pixels [start, end) of a row
+    struct Run {
+        int row, start, end;
+    };
+
+    // Integer moment sums, which are exact
+    struct Stats {
+        int64_t area {0}, sum_x {0}, sum_y {0};
+        int x0 {0}, y0 {0}, x1 {0}, y1 {0};
+        void add(const Run& run);
+        void merge(const Stats& other);
+    };
+
+    struct Band {
+        cv::Range rows;
+        std::vector<Run> runs;
+        std::vector<int> parent;    // Union-find forest over runs
+        std::vector<int> run_label; // Component of each run
+        std::vector<Stats> stats;   // Indexed by component
+        size_t first_row_end {0};   // Runs in the first row are [0, first_row_end)
+        size_t last_row_begin {0};  // Runs in the last row are [last_row_begin, end)
+        int label_offset {0};       // Index of this band's first global label
+    };
+
+    std::vector<Band> bands;
+    std::vector<int> parent;        // Union-find forest over all band labels
+    std::vector<int> blob_index;
+    std::vector<Stats> merged;
+    std::vector<Blob> blobs;
+
+    static int find(std::vector<int>& parent, int i);
+    static void unite(std::vector<int>& parent, int a, int b);
+
+    // Calls unite(a, b) for each pair of touching runs from adjacent rows
+    template <typename Unite>
+    static void joinRows(const Run* above, const Run* above_end,
+                         const Run* below, const Run* below_end, Unite unite);
+
+    static void labelBand(const cv::Mat& mask, Band& band);
+
+    // Labels a range of bands
+    class BandBody : public cv::ParallelLoopBody {
+    public:
+
+        BandBody(const cv::Mat& mask, std::vector<Band>& bands) :
+          mask_(mask)
+        , bands_(bands) { }
+
+        void operator()(const cv::Range& range) const override;
+
+    private:
+
+        const cv::Mat& mask_;
+        std::vector<Band>& bands_;
+    };
+};
+
+#endif	/* BLOBLABELER_H */
@@ -19,6 +19,7 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
 #include <string>
 #include <opencv2/opencv.hpp>
 
@@ -28,6 +29,33 @@
 
 #include "DifferenceDetector.h"
 
+namespace {
+
+    // Threshold the absolute difference between two rows of gray pixels in
+    // one pass. The inner loop has no branches so that it can be vectorized
+    // by the compiler.
+    void absDiffThresholdRow(const uchar* a, const uchar* b, uchar* out,
+                             const int n, const uchar thresh, const uchar on) {
+
+        for (int k = 0; k < n; k++) {
+            const uchar d = std::max(a[k], b[k]) - std::min(a[k], b[k]);
+            out[k] = (d > thresh) ? on : 0;
+        }
+    }
+
+    // Add or remove a row of a 0/1 mask from running column sums
+    void accumulateRow(const uchar* row, uint16_t* sums, const int n, const bool add) {
+
+        if (add) {
+            for (int k = 0; k < n; k++)
+                sums[k] += row[k];
+        } else {
+            for (int k = 0; k < n; k++)
+                sums[k] -= row[k];
+        }
+    }
+}
+
 DifferenceDetector2D::DifferenceDetector2D(const std::string& image_source_name, const std::string& position_sink_name) :
 PositionDetector(image_source_name, position_sink_name)
 , tuning_image_title(position_sink_name + "_tuning")
@@ -42,10 +70,22 @@ PositionDetector(image_source_name, position_sink_name)
 
 oat::Position2D DifferenceDetector2D::detectPosition(cv::Mat& frame) {
 
+    // Tuning shows the whole frame
+    roi = tuning_on ? 
+        cv::Rect(0, 0, frame.cols, frame.rows) : 
+        search_window.region(frame.size());
+
     this_image = frame;
     applyThreshold();
     siftBlobs();
     tune();
+
+    if (object_position.position_valid) {
+        object_position.position.x += roi.x;
+        object_position.position.y += roi.y;
+    }
+
+    search_window.update(object_position);
     
     return object_position;
 }
@@ -53,7 +93,7 @@ oat::Position2D DifferenceDetector2D::detectPosition(cv::Mat& frame) {
 void DifferenceDetector2D::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"blur", "diff_threshold", "tune"};
+    std::vector<std::string> options {"blur", "diff_threshold", "search_window", "tune"};
     
     // This will throw cpptoml::parse_exception if a file 
     // with invalid TOML is provided
@@ -83,6 +123,13 @@ void DifferenceDetector2D::configure(const std::string& config_file, const std::
             difference_intensity_threshold = val;
         }       
 
+        // Search window
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "search_window", val, (int64_t)0))
+                search_window.set_size(val);
+        }
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on);
         if (tuning_on) {
@@ -97,44 +144,37 @@ void DifferenceDetector2D::configure(const std::string& config_file, const std::
 
 void DifferenceDetector2D::siftBlobs() {
 
-    cv::Mat thresh_cpy = threshold_image.clone();
-    std::vector< std::vector < cv::Point > > contours;
-    std::vector< cv::Vec4i > hierarchy;
+    const auto& blobs = blob_labeler.label(threshold_image);
     cv::Rect objectBoundingRectangle;
 
-    //these two vectors needed for output of findContours
-    //find contours of filtered image using openCV findContours function
-    //findContours(temp,contours,hierarchy,CV_RETR_CCOMP,CV_CHAIN_APPROX_SIMPLE );// retrieves all contours
-    cv::findContours(thresh_cpy, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE); // retrieves external contours
+    // Assume that the largest blob is the object we are looking for
+    const Blob* largest = nullptr;
+    for (const auto& blob : blobs) {
+        if (!largest || blob.area() > largest->area())
+            largest = &blob;
+    }
 
-    //if contours vector is not empty, we have found some objects
-    if (contours.size() > 0) {
-        object_position.position_valid = true;
-    } else
-        object_position.position_valid = false;
+    object_position.position_valid = (largest != nullptr);
 
     if (object_position.position_valid) {
 
-        //the largest contour is found at the end of the contours vector
-        //we will simply assume that the biggest contour is the object we are looking for.
-        std::vector< std::vector<cv::Point> > largestContourVec;
-        largestContourVec.push_back(contours.at(contours.size() - 1));
-
-        //make a bounding rectangle around the largest contour then find its centroid
-        //this will be the object's final estimated position.
-        objectBoundingRectangle = cv::boundingRect(largestContourVec.at(0));
+        // The center of the blob's bounding rectangle is the object's
+        // estimated position
+        objectBoundingRectangle = largest->bounding_box;
         object_position.position.x = objectBoundingRectangle.x + 0.5 * objectBoundingRectangle.width;
         object_position.position.y = objectBoundingRectangle.y + 0.5 * objectBoundingRectangle.height;
     }
 
     if (tuning_on) {
 
-        std::string msg = cv::format("Object not found"); // TODO: This default msg will not show up. I have no idea why.
+        std::string msg = cv::format("Object not found");
 
-        // Plot a circle representing found object
+        // Color copy for display, so that annotations show up
+        cv::cvtColor(threshold_image, tune_image, cv::COLOR_GRAY2BGR);
+
+        // Plot a rectangle around the found object
         if (object_position.position_valid) {
-            cv::cvtColor(threshold_image, threshold_image, cv::COLOR_GRAY2BGR);
-            cv::rectangle(threshold_image, objectBoundingRectangle.tl(), objectBoundingRectangle.br(), cv::Scalar(0, 0, 255), 2);
+            cv::rectangle(tune_image, objectBoundingRectangle.tl(), objectBoundingRectangle.br(), cv::Scalar(0, 0, 255), 2);
             msg = cv::format("(%d, %d) pixels", (int) object_position.position.x, (int) object_position.position.y);
 
         }
@@ -142,31 +182,111 @@ void DifferenceDetector2D::siftBlobs() {
         int baseline = 0;
         cv::Size textSize = cv::getTextSize(msg, 1, 1, 1, &baseline);
         cv::Point text_origin(
-                threshold_image.cols - textSize.width - 10,
-                threshold_image.rows - 2 * baseline - 10);
+                tune_image.cols - textSize.width - 10,
+                tune_image.rows - 2 * baseline - 10);
 
-        cv::putText(threshold_image, msg, text_origin, 1, 1, cv::Scalar(0, 255, 0));
+        cv::putText(tune_image, msg, text_origin, 1, 1, cv::Scalar(0, 255, 0));
     }
 }
 
 void DifferenceDetector2D::applyThreshold() {
 
+    // Buffers span the whole frame and are only reallocated if its size
+    // changes. Each step works on the view of its buffer covered by the roi.
+    const cv::Size size = this_image.size();
+    if (gray[0].size() != size) {
+        gray[0].create(size, CV_8UC1);
+        gray[1].create(size, CV_8UC1);
+        motion_buffer.create(size, CV_8UC1);
+        threshold_buffer.create(size, CV_8UC1);
+        last_image_set = false;
+    }
+
+    cv::Mat this_gray = gray[current_gray](roi);
+    cv::Mat last_gray = gray[current_gray ^ 1](roi);
+    threshold_image = threshold_buffer(roi);
+
+    cv::cvtColor(this_image(roi), this_gray, cv::COLOR_BGR2GRAY);
+
     if (last_image_set) {
-        cv::cvtColor(this_image, this_image, cv::COLOR_BGR2GRAY);
-        cv::absdiff(this_image, last_image, threshold_image);
-        cv::threshold(threshold_image, threshold_image, difference_intensity_threshold, 255, cv::THRESH_BINARY);
+
+        // The previous frame was converted within last_roi. It only needs to
+        // be converted again if this roi reaches outside of that.
+        if ((roi & last_roi) != roi)
+            cv::cvtColor(last_image(roi), last_gray, cv::COLOR_BGR2GRAY);
+
+        const uchar thresh = cv::saturate_cast<uchar>(difference_intensity_threshold);
+
         if (blur_on) {
-            cv::blur(threshold_image, threshold_image, blur_size);
+            cv::Mat motion = motion_buffer(roi);
+            for (int i = 0; i < roi.height; i++)
+                absDiffThresholdRow(this_gray.ptr<uchar>(i), last_gray.ptr<uchar>(i),
+                        motion.ptr<uchar>(i), roi.width, thresh, 1);
+            boxThreshold(motion, threshold_image);
+        } else {
+            for (int i = 0; i < roi.height; i++)
+                absDiffThresholdRow(this_gray.ptr<uchar>(i), last_gray.ptr<uchar>(i),
+                        threshold_image.ptr<uchar>(i), roi.width, thresh, 255);
         }
-        cv::threshold(threshold_image, threshold_image, difference_intensity_threshold, 255, cv::THRESH_BINARY);
-        last_image = this_image.clone(); // Get a copy of the last image
+
     } else {
-        threshold_image = this_image.clone();
-        cv::cvtColor(threshold_image, threshold_image, cv::COLOR_BGR2GRAY);
-        last_image = this_image.clone();
-        cv::cvtColor(last_image, last_image, cv::COLOR_BGR2GRAY);
+
+        // Nothing has moved yet
+        threshold_image.setTo(0);
         last_image_set = true;
     }
+
+    // Frames from SOURCE are not reused, so the previous frame can be kept
+    // without copying it
+    last_image = this_image;
+    last_roi = roi;
+    current_gray ^= 1;
+}
+
+void DifferenceDetector2D::boxThreshold(const cv::Mat& motion, cv::Mat& out) {
+
+    // Equivalent to blurring the 0/255 motion mask with a normalized box
+    // filter and thresholding the result, but counts set pixels in the box
+    // with running sums instead. Pixels outside the frame count as unset.
+    const int rows = motion.rows;
+    const int cols = motion.cols;
+    const int k = blur_size.height;
+    const int a = k / 2;
+    const int limit = difference_intensity_threshold * k * k;
+
+    // Column sums over the rows of the box
+    column_sums.assign(cols, 0);
+    for (int r = 0; r < std::min(rows, k - 1 - a); r++)
+        accumulateRow(motion.ptr<uchar>(r), column_sums.data(), cols, true);
+
+    for (int i = 0; i < rows; i++) {
+
+        const int r_in = i - a + k - 1;
+        const int r_out = i - a - 1;
+        if (r_in < rows)
+            accumulateRow(motion.ptr<uchar>(r_in), column_sums.data(), cols, true);
+        if (r_out >= 0)
+            accumulateRow(motion.ptr<uchar>(r_out), column_sums.data(), cols, false);
+
+        // Sum column sums over the columns of the box
+        const uint16_t* sums = column_sums.data();
+        uchar* o = out.ptr<uchar>(i);
+        int count = 0;
+        for (int c = 0; c < std::min(cols, k - 1 - a); c++)
+            count += sums[c];
+
+        for (int j = 0; j < cols; j++) {
+
+            const int c_in = j - a + k - 1;
+            const int c_out = j - a - 1;
+            if (c_in < cols)
+                count += sums[c_in];
+            if (c_out >= 0)
+                count -= sums[c_out];
+
+            o[j] = (count * 255 > limit) ? 255 : 0;
+        }
+    }
 }
 
 void DifferenceDetector2D::tune() {
@@ -175,7 +295,7 @@ void DifferenceDetector2D::tune() {
         if (!tuning_windows_created) {
             createTuningWindows();
         }
-        cv::imshow(tuning_image_title, threshold_image);
+        cv::imshow(tuning_image_title, tune_image);
         cv::waitKey(1);
 
     } else if (!tuning_on && tuning_windows_created) {
@@ -20,7 +20,12 @@
 #ifndef DIFFERENCEDETECTOR_H
 #define	DIFFERENCEDETECTOR_H
 
+#include <cstdint>
+#include <vector>
+
 #include "PositionDetector.h"
+#include "BlobLabeler.h"
+#include "SearchWindow.h"
 
 /**
  * Motion-based object position detector.
@@ -47,10 +52,23 @@ public:
     void configure(const std::string& config_file, const std::string& key);
 private:
     
-    // Intermediate variables
+    // Intermediate variables. The gray buffers alternate between holding
+    // the current and previous frames.
     cv::Mat this_image, last_image;
+    cv::Mat gray[2];
+    int current_gray {0};
+    cv::Mat motion_buffer, threshold_buffer;
     cv::Mat threshold_image;
+    std::vector<uint16_t> column_sums;
     bool last_image_set;
+
+    // Region of the frame to search. Only this region of the current and
+    // previous frames is converted and differenced.
+    SearchWindow search_window;
+    cv::Rect roi, last_roi;
+
+    // Connected components of the threshold image
+    BlobLabeler blob_labeler;
     
     // Object detection
     double object_area;
@@ -76,6 +94,7 @@ private:
     // TODO: These are terrible - no IO signature other than void -> void,
     // no exceptions, etc
     void applyThreshold(void);
+    void boxThreshold(const cv::Mat& motion, cv::Mat& out);
     void set_blur_size(int value);
     void siftBlobs(void);
     void servePosition(void);
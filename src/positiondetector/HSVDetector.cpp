@@ -19,6 +19,7 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
 #include <string>
 #include <limits>
 #include <math.h>
@@ -60,23 +61,82 @@ HSVDetector::HSVDetector(const std::string& image_source_name, const std::string
 #endif
 }
 
-oat::Position2D HSVDetector::detectPosition(cv::Mat& frame_in) {
+oat::Position2D HSVDetector::detectPosition(cv::Mat& full_frame) {
+
+    // Tuning shows the whole frame. When several objects are detected, they
+    // are not all near the predicted position.
+    const cv::Rect roi = (tuning_on || get_max_objects() > 0) ? 
+        cv::Rect(0, 0, full_frame.cols, full_frame.rows) : 
+        search_window.region(full_frame.size());
+    cv::Mat frame_in = full_frame(roi);
 
 #ifdef NOIMP_OAT_USE_CUDA
     hsv_image.upload(frame_in);
     cv::cuda::cvtColor(hsv_image, hsv_image, cv::COLOR_BGR2HSV);
+    applyThreshold();
+    erodeDilate();
 #else
-    cv::cvtColor(frame_in, hsv_image, cv::COLOR_BGR2HSV);
+    // Blobs are found in a decimated frame and refined at full resolution.
+    // Tuning works at full resolution.
+    current_decimation = tuning_on ? 1 : decimation;
+    if (frame_in.cols < current_decimation || frame_in.rows < current_decimation)
+        current_decimation = 1;
+
+    cv::Mat search_in = frame_in;
+    if (current_decimation > 1) {
+
+        // Whole blocks only, so that the area reduction is an exact
+        // integer factor
+        const int d = current_decimation;
+        cv::Mat blocks = frame_in(cv::Rect(0, 0, 
+                frame_in.cols / d * d, frame_in.rows / d * d));
+        cv::resize(blocks, coarse_frame, 
+                cv::Size(blocks.cols / d, blocks.rows / d), 0, 0, cv::INTER_AREA);
+        search_in = coarse_frame;
+    }
+
+    // Tuning displays the whole thresholded frame, so it is done in one piece
+    const int n = tuning_on ? 1 : numBands(search_in.rows);
+    if (n > 1) {
+        thresholdBands(search_in, n);
+    } else {
+        if (lut_bits > 0) {
+            applyLUT(search_in);
+        } else {
+            cv::cvtColor(search_in, hsv_image, cv::COLOR_BGR2HSV);
+            applyThreshold();
+        }
+        erodeDilate();
+    }
 #endif
     
-    applyThreshold();
-    erodeDilate();
-    siftBlobs();
+    siftBlobs(frame_in);
     tune();
 
+    if (object_position.position_valid) {
+        object_position.position.x += roi.x;
+        object_position.position.y += roi.y;
+    }
+
+    search_window.update(object_position);
+
     return object_position;
 }
 
+void HSVDetector::detectPositions(cv::Mat& frame, oat::Position2DArray& positions) {
+
+    // Whole frame is searched, so blob positions need no offset
+    detectPosition(frame);
+
+    positions.clear();
+    for (const Blob& blob : objects) {
+        oat::Position2D position;
+        position.position = blob.centroid();
+        position.position_valid = true;
+        positions.push_back(position);
+    }
+}
+
 void HSVDetector::applyThreshold() {
     
 #ifdef NOIMP_OAT_USE_CUDA
@@ -88,10 +148,142 @@ void HSVDetector::applyThreshold() {
     cv::cuda::bitwise_and(channels[2], threshold_frame, threshold_frame);
 #else  
     cv::inRange(hsv_image, cv::Scalar(h_min, s_min, v_min), cv::Scalar(h_max, s_max, v_max), threshold_frame);
-    hsv_image.setTo(0, threshold_frame == 0);
+
+    // Masked image is only needed for display
+    if (tuning_on)
+        hsv_image.setTo(0, threshold_frame == 0);
 #endif
 }
 
+#ifndef NOIMP_OAT_USE_CUDA
+void HSVDetector::refineObjects(const cv::Mat& frame) {
+
+    const int d = current_decimation;
+    const cv::Rect bounds(0, 0, frame.cols, frame.rows);
+
+    for (auto& object : objects) {
+
+        // Full resolution window around the blob, padded by one block
+        const cv::Rect& bb = object.bounding_box;
+        const cv::Rect window = 
+            cv::Rect(bb.x - d, bb.y - d, bb.width + 2 * d, bb.height + 2 * d) & bounds;
+        const cv::Mat patch = frame(window);
+
+        if (lut_bits > 0) {
+            color_lut.apply(patch, refine_mask);
+        } else {
+            cv::cvtColor(patch, refine_hsv, cv::COLOR_BGR2HSV);
+            cv::inRange(refine_hsv, cv::Scalar(h_min, s_min, v_min), 
+                    cv::Scalar(h_max, s_max, v_max), refine_mask);
+        }
+
+        // Remove isolated pixels, as is done to the coarse mask
+        if (erode_on)
+            cv::erode(refine_mask, refine_mask, erode_element);
+
+        // Sub-pixel centroid of the pixels that pass within the window. If
+        // none do, the coarse centroid is kept. The coarse area, which the
+        // blob was filtered by, is kept as the object's area.
+        const cv::Moments m = cv::moments(refine_mask, true);
+        if (m.m00 > 0) {
+            object.m10 = object.m00 * (m.m10 / m.m00 + window.x);
+            object.m01 = object.m00 * (m.m01 / m.m00 + window.y);
+        }
+    }
+}
+
+int HSVDetector::morphologyHalo() const {
+
+    // Rows above or below a pixel that erode, then dilate, can reach
+    const bool coarse = current_decimation > 1;
+    int halo = 0;
+    if (erode_on)
+        halo += (coarse ? coarse_erode_element : erode_element).rows / 2;
+    if (dilate_on)
+        halo += (coarse ? coarse_dilate_element : dilate_element).rows / 2;
+
+    return halo;
+}
+
+int HSVDetector::numBands(const int rows) const {
+
+    // Bands are at least twice as tall as their halos, so that no more
+    // than half of the thresholding and morphology is repeated
+    const int min_rows = std::max(MIN_BAND_ROWS, 4 * morphologyHalo());
+    return std::max(1, std::min(cv::getNumThreads(), rows / min_rows));
+}
+
+void HSVDetector::thresholdBands(const cv::Mat& frame, const int n) {
+
+    if (lut_bits > 0)
+        color_lut.build({{h_min, h_max, s_min, s_max, v_min, v_max}}, lut_bits);
+
+    threshold_frame.create(frame.size(), CV_8UC1);
+
+    bands.resize(n);
+    for (int i = 0; i < n; i++)
+        bands[i].rows = cv::Range(i * frame.rows / n, (i + 1) * frame.rows / n);
+
+    cv::parallel_for_(cv::Range(0, n), 
+            BandBody(*this, frame, bands, threshold_frame), n);
+}
+
+void HSVDetector::processBand(const cv::Mat& frame, Band& band, cv::Mat& out) const {
+
+    // Band padded by its halo, within the frame
+    const int halo = morphologyHalo();
+    const cv::Range padded(std::max(band.rows.start - halo, 0), 
+                           std::min(band.rows.end + halo, frame.rows));
+    const cv::Mat in = frame.rowRange(padded);
+
+    if (lut_bits > 0) {
+        color_lut.apply(in, band.mask);
+    } else {
+        cv::cvtColor(in, band.hsv, cv::COLOR_BGR2HSV);
+        cv::inRange(band.hsv, cv::Scalar(h_min, s_min, v_min), 
+                cv::Scalar(h_max, s_max, v_max), band.mask);
+    }
+
+    // Errors due to the edges of the padded band reach at most halo rows
+    // in, so the band's own rows match whole frame morphology
+    const bool coarse = current_decimation > 1;
+
+    if (erode_on) {
+        cv::erode(band.mask, band.mask, 
+                coarse ? coarse_erode_element : erode_element);
+    }
+
+    if (dilate_on) {
+        cv::dilate(band.mask, band.mask, 
+                coarse ? coarse_dilate_element : dilate_element);
+    }
+
+    const int top = band.rows.start - padded.start;
+    band.mask.rowRange(top, top + band.rows.size()).copyTo(out.rowRange(band.rows));
+}
+
+void HSVDetector::BandBody::operator()(const cv::Range& range) const {
+
+    for (int i = range.start; i < range.end; i++)
+        detector_.processBand(frame_, bands_[i], out_);
+}
+
+void HSVDetector::applyLUT(const cv::Mat& frame) {
+
+    // Only rebuilt if the thresholds have been changed, e.g. by the tuning
+    // sliders
+    color_lut.build({{h_min, h_max, s_min, s_max, v_min, v_max}}, lut_bits);
+    color_lut.apply(frame, threshold_frame);
+
+    // For display, show the pixels that passed in their original colors
+    if (tuning_on) {
+        hsv_image.create(frame.size(), frame.type());
+        hsv_image.setTo(0);
+        frame.copyTo(hsv_image, threshold_frame);
+    }
+}
+#endif
+
 void HSVDetector::erodeDilate() {
     
 #ifdef NOIMP_OAT_USE_CUDA
@@ -103,66 +295,94 @@ void HSVDetector::erodeDilate() {
         dilate_filter->apply(threshold_frame, threshold_frame);
     }
 #else     
+    const bool coarse = current_decimation > 1;
+
     if (erode_on) {
-        cv::erode(threshold_frame, threshold_frame, erode_element);
+        cv::erode(threshold_frame, threshold_frame, 
+                coarse ? coarse_erode_element : erode_element);
     }
 
     if (dilate_on) {
-        cv::dilate(threshold_frame, threshold_frame, dilate_element);
+        cv::dilate(threshold_frame, threshold_frame, 
+                coarse ? coarse_dilate_element : dilate_element);
     }
 #endif
 }
 
-void HSVDetector::siftBlobs() {
+void HSVDetector::siftBlobs(const cv::Mat& frame) {
 
-    cv::Mat thesh_cpy;
-    
 #ifdef NOIMP_OAT_USE_CUDA
-    threshold_frame.download(thesh_cpy);
+    threshold_frame.download(search_frame);
+    const auto& blobs = blob_labeler.label(search_frame);
 #else
-    thesh_cpy = threshold_frame.clone();
+    const auto& blobs = blob_labeler.label(threshold_frame);
 #endif
-    
-    std::vector< std::vector < cv::Point > > contours;
-    std::vector< cv::Vec4i > hierarchy;
-
-    // This function will modify the threshold_img data.
-    cv::findContours(thesh_cpy, contours, hierarchy, cv::RETR_CCOMP, cv::CHAIN_APPROX_SIMPLE);
 
     object_area = 0;
     object_position.position_valid = false;
 
-    if (hierarchy.size() > 0) {
+    // Each pixel of a decimated frame covers d x d full frame pixels
+#ifdef NOIMP_OAT_USE_CUDA
+    const int d = 1;
+#else
+    const int d = current_decimation;
+#endif
+    const double block_area = d * d;
+
+    // Isolate the largest blobs within the min/max range.
+    candidates.clear();
+    for (const auto& blob : blobs) {
+        double area = blob.area() * block_area;
+        if (area > min_object_area && area < max_object_area)
+            candidates.push_back(&blob);
+    }
 
-        for (int index = 0; index >= 0; index = hierarchy[index][0]) {
+    const size_t n = std::min(candidates.size(), std::max<size_t>(get_max_objects(), 1));
+    std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end(),
+            [](const Blob* a, const Blob* b) { return a->area() > b->area(); });
+
+    // Map blobs to full frame pixels. The center of a block is offset from
+    // its corner by (d - 1) / 2.
+    objects.clear();
+    for (size_t i = 0; i < n; i++) {
+
+        const Blob& blob = *candidates[i];
+        const cv::Point2d c = blob.centroid() * d + cv::Point2d(0.5 * (d - 1), 0.5 * (d - 1));
+        const cv::Rect& bb = blob.bounding_box;
+
+        Blob object;
+        object.m00 = blob.m00 * block_area;
+        object.m10 = object.m00 * c.x;
+        object.m01 = object.m00 * c.y;
+        object.bounding_box = cv::Rect(bb.x * d, bb.y * d, bb.width * d, bb.height * d);
+        objects.push_back(object);
+    }
 
-            cv::Moments moment = cv::moments((cv::Mat)contours[index]);
-            double area = moment.m00;
+#ifndef NOIMP_OAT_USE_CUDA
+    if (d > 1)
+        refineObjects(frame);
+#endif
 
-            // Isolate the largest contour within the min/max range.
-            if (area > min_object_area && area < max_object_area && area > object_area) {
-                object_position.position.x = moment.m10 / area;
-                object_position.position.y = moment.m01 / area;
-                object_position.position_valid = true;
-                object_area = area;
-            }
-        }
+    if (!objects.empty()) {
+        object_position.position = objects[0].centroid();
+        object_position.position_valid = true;
+        object_area = objects[0].area();
     }
 
     if (tuning_on) {
         
         std::string msg = cv::format("Object not found"); 
 
-        // Plot a circle representing found object
-        if (object_position.position_valid) {
-            auto radius = std::sqrt(object_area / PI);
-            cv::Point center;
-            center.x = object_position.position.x;
-            center.y = object_position.position.y;
+        // Plot a circle representing each found object
+        for (const Blob& blob : objects) {
+            auto radius = std::sqrt(blob.area() / PI);
+            cv::Point center = blob.centroid();
             cv::circle(hsv_image, center, radius, cv::Scalar(0, 0, 255), 2);
-            msg = cv::format("(%d, %d) pixels", (int) object_position.position.x, (int) object_position.position.y);
         }
 
+        if (object_position.position_valid)
+            msg = cv::format("(%d, %d) pixels", (int) object_position.position.x, (int) object_position.position.y);
+
         int baseline = 0;
         cv::Size textSize = cv::getTextSize(msg, 1, 1, 1, &baseline);
         cv::Point text_origin(
@@ -183,6 +403,10 @@ void HSVDetector::configure(const std::string& config_file, const std::string& c
                                       "h_thresholds", 
                                       "s_thresholds", 
                                       "v_thresholds", 
+                                      "lut_bits",
+                                      "decimate",
+                                      "search_window",
+                                      "max_objects",
                                       "tune" };
     
     // This will throw cpptoml::parse_exception if a file 
@@ -249,6 +473,36 @@ void HSVDetector::configure(const std::string& config_file, const std::string& c
             v_max = val; 
         }
 
+        // Search window
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "search_window", val, (int64_t)0))
+                search_window.set_size(val);
+        }
+
+        // Multiple objects
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "max_objects", val, (int64_t)0))
+                set_max_objects(val);
+        }
+
+#ifndef NOIMP_OAT_USE_CUDA
+        // Color lookup table
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "lut_bits", val, (int64_t)0, (int64_t)8))
+                lut_bits = val;
+        }
+
+        // Coarse to fine detection
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "decimate", val, (int64_t)1, (int64_t)16))
+                set_decimation(val);
+        }
+#endif
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on);
         if (tuning_on) {
@@ -374,6 +628,9 @@ void HSVDetector::set_erode_size(int value) {
         erode_on = true;
         erode_px = value;
         erode_element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(erode_px, erode_px));
+        const int coarse_px = std::max(1, cvRound(static_cast<double>(erode_px) / decimation));
+        coarse_erode_element = 
+            cv::getStructuringElement(cv::MORPH_RECT, cv::Size(coarse_px, coarse_px));
     } else {
         erode_on = false;
     }
@@ -384,10 +641,21 @@ void HSVDetector::set_dilate_size(int value) {
         dilate_on = true;
         dilate_px = value;
         dilate_element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(dilate_px, dilate_px));
+        const int coarse_px = std::max(1, cvRound(static_cast<double>(dilate_px) / decimation));
+        coarse_dilate_element = 
+            cv::getStructuringElement(cv::MORPH_RECT, cv::Size(coarse_px, coarse_px));
     } else {
         dilate_on = false;
     }
 }
+
+void HSVDetector::set_decimation(int value) {
+
+    // Morphology elements are scaled to the decimated frame
+    decimation = value;
+    set_erode_size(erode_on ? erode_px : 0);
+    set_dilate_size(dilate_on ? dilate_px : 0);
+}
 #endif // NOIMP_OAT_USE_CUDA
 
 void HSVDetector::minAreaSliderChangedCallback(int value, void* object) {
@@ -23,7 +23,9 @@
 #include "OatConfig.h" // Generated by CMake
 
 #include <string>
+#include <vector>
 #include <opencv2/core/mat.hpp>
+#include <opencv2/core/utility.hpp>
 #ifdef NOIMP_OAT_USE_CUDA
 #include <opencv2/core/cuda.hpp>
 #include <opencv2/cudaarithm.hpp>
@@ -31,7 +33,11 @@
 #include <opencv2/cudaimgproc.hpp>
 #endif
 
+#include "../../lib/utility/ColorLUT.h"
+
 #include "PositionDetector.h"
+#include "BlobLabeler.h"
+#include "SearchWindow.h"
 
 /**
  * A color-based object position detector
@@ -53,6 +59,13 @@ public:
      * @return  detected object position.
      */
     oat::Position2D detectPosition(cv::Mat& frame);
+
+    /**
+     * Detect up to get_max_objects() objects, largest first.
+     * @param frame frame to look for objects in.
+     * @param positions detected object positions.
+     */
+    void detectPositions(cv::Mat& frame, oat::Position2DArray& positions);
     
     void configure(const std::string& config_file, const std::string& config_key);
 
@@ -74,6 +87,61 @@ private:
     cv::Ptr<cv::cuda::Filter> dilate_filter;
 #else
     cv::Mat hsv_image, threshold_frame, erode_element, dilate_element;
+
+    // Classify BGR pixels directly with a lookup table built from the HSV
+    // thresholds, instead of converting each frame to HSV. Bits per channel
+    // of the table index. 0 to convert each frame.
+    int lut_bits {8};
+    oat::ColorLUT color_lut;
+    void applyLUT(const cv::Mat& frame);
+
+    // Coarse to fine detection. Blobs are found in frames decimated by this
+    // factor, using morphology elements scaled to match, and their centroids
+    // are then refined at full resolution. 1 to work at full resolution.
+    int decimation {1};
+    int current_decimation {1};
+    cv::Mat coarse_frame, coarse_erode_element, coarse_dilate_element;
+    cv::Mat refine_hsv, refine_mask;
+    void refineObjects(const cv::Mat& frame);
+    void set_decimation(int value);
+
+    // Thresholding and morphology are split across horizontal bands of the
+    // frame and run in parallel. Each band is thresholded along with enough
+    // rows of its neighbours (its halo) that erode and dilate are exact at
+    // its edges, and only its own rows are copied to threshold_frame.
+    static constexpr int MIN_BAND_ROWS {32};
+
+    struct Band {
+        cv::Range rows;
+        cv::Mat hsv, mask;
+    };
+
+    std::vector<Band> bands;
+    int morphologyHalo(void) const;
+    int numBands(const int rows) const;
+    void thresholdBands(const cv::Mat& frame, const int n);
+    void processBand(const cv::Mat& frame, Band& band, cv::Mat& out) const;
+
+    // Processes a range of bands
+    class BandBody : public cv::ParallelLoopBody {
+    public:
+
+        BandBody(const HSVDetector& detector, const cv::Mat& frame, 
+                 std::vector<Band>& bands, cv::Mat& out) :
+          detector_(detector)
+        , frame_(frame)
+        , bands_(bands)
+        , out_(out) { }
+
+        void operator()(const cv::Range& range) const override;
+
+    private:
+
+        const HSVDetector& detector_;
+        const cv::Mat& frame_;
+        std::vector<Band>& bands_;
+        cv::Mat& out_;
+    };
 #endif
 
     // HSV threshold values
@@ -90,6 +158,17 @@ private:
     // The detected object position
     oat::Position2D object_position;
 
+    // Region of the frame to search
+    SearchWindow search_window;
+
+    // Connected components of the threshold frame
+    BlobLabeler blob_labeler;
+
+    // Blobs within the area range, largest first. At most get_max_objects(),
+    // or 1 if that is 0. Objects are in full frame pixels.
+    std::vector<const Blob*> candidates;
+    std::vector<Blob> objects;
+
     // Processing segregation 
     // TODO: These are terrible - no IO signature other than void -> void,
     
@@ -105,7 +184,7 @@ private:
     void erodeDilate(void);
     
     // Sift through thresholded blobs to pull out potential object
-    void siftBlobs(void);
+    void siftBlobs(const cv::Mat& frame);
    
     // Parameter tuning GUI functions and properties
     bool tuning_on;
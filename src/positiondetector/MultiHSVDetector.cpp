@@ -0,0 +1,243 @@
+//******************************************************************************
+//* File:   MultiHSVDetector.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "MultiHSVDetector.h"
+
+MultiHSVDetector::MultiHSVDetector(const std::string& source_name, const std::string& pos_sink_name) :
+  PositionDetector(source_name, pos_sink_name, false)
+, sink_prefix(pos_sink_name) { }
+
+void MultiHSVDetector::configure(const std::string& config_file, const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"colors", "lut_bits"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    cpptoml::table config;
+    config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config.contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config.get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        oat::config::Table color_config;
+        if (!oat::config::getTable(this_config, "colors", color_config) || 
+                color_config->begin() == color_config->end()) {
+            throw (std::runtime_error(oat::configValueError("colors", config_key,
+                    config_file, "must be a table with at least one color")));
+        }
+
+        std::vector<std::string> color_options {"h_thresholds", 
+                                                "s_thresholds", 
+                                                "v_thresholds", 
+                                                "erode", 
+                                                "dilate", 
+                                                "min_area", 
+                                                "max_area"};
+
+        // Sorted so that SINKs are created in a predictable order
+        std::vector<std::string> names;
+        for (auto it = color_config->begin(); it != color_config->end(); it++)
+            names.push_back(it->first);
+        std::sort(names.begin(), names.end());
+
+        colors.clear();
+        for (const auto& n : names) {
+
+            oat::config::Table this_color;
+            oat::config::getTable(color_config, n, this_color);
+            oat::config::checkKeys(color_options, this_color);
+
+            Color color;
+            color.name = n;
+
+            oat::config::Table t;
+            int64_t val;
+            if (oat::config::getTable(this_color, "h_thresholds", t)) {
+                oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+                color.h_min = val;
+                oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+                color.h_max = val;
+            }
+
+            if (oat::config::getTable(this_color, "s_thresholds", t)) {
+                oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+                color.s_min = val;
+                oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+                color.s_max = val;
+            }
+
+            if (oat::config::getTable(this_color, "v_thresholds", t)) {
+                oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+                color.v_min = val;
+                oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+                color.v_max = val;
+            }
+
+            if (oat::config::getValue(this_color, "erode", val, (int64_t)0) && val > 0) {
+                color.erode_element = cv::getStructuringElement(cv::MORPH_RECT, 
+                        cv::Size(val, val));
+            }
+
+            if (oat::config::getValue(this_color, "dilate", val, (int64_t)0) && val > 0) {
+                color.dilate_element = cv::getStructuringElement(cv::MORPH_RECT, 
+                        cv::Size(val, val));
+            }
+
+            oat::config::getValue(this_color, "min_area", color.min_area, 0.0);
+            oat::config::getValue(this_color, "max_area", color.max_area, 0.0);
+
+            colors.push_back(color);
+        }
+
+        position_sinks.clear();
+        for (const auto& color : colors) {
+            position_sinks.emplace_back(
+                    new oat::SMServer<oat::Position2D>(sink_prefix + "_" + color.name));
+        }
+
+        positions.resize(colors.size());
+
+        int64_t val;
+        if (oat::config::getValue(this_config, "lut_bits", val, (int64_t)0, (int64_t)8))
+            lut_bits = val;
+
+        if (lut_bits > 0) {
+
+            if (colors.size() > oat::ColorLUT::MAX_RANGES) {
+                throw (std::runtime_error(oat::configValueError("lut_bits", config_key,
+                        config_file, "must be 0 if there are more than 8 colors")));
+            }
+
+            std::vector<oat::HSVRange> ranges;
+            for (const auto& c : colors)
+                ranges.push_back({c.h_min, c.h_max, c.s_min, c.s_max, c.v_min, c.v_max});
+
+            color_lut.build(ranges, lut_bits);
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+oat::Position2D MultiHSVDetector::detectPosition(cv::Mat& frame) {
+
+    const size_t n_colors = colors.size();
+
+    if (lut_bits > 0) {
+
+        // One table read gives the colors of each pixel. Each color's mask
+        // is then one vectorized bit test of the class image.
+        color_lut.apply(frame, class_image);
+
+        for (size_t k = 0; k < n_colors; k++)
+            cv::bitwise_and(class_image, cv::Scalar(1 << k), colors[k].mask);
+
+    } else {
+
+        cv::cvtColor(frame, hsv_image, cv::COLOR_BGR2HSV);
+
+        for (auto& c : colors)
+            c.mask.create(hsv_image.size(), CV_8UC1);
+
+        std::vector<uchar*> mask_rows(n_colors);
+
+        for (int i = 0; i < hsv_image.rows; i++) {
+
+            const uchar* p = hsv_image.ptr<uchar>(i);
+            for (size_t k = 0; k < n_colors; k++)
+                mask_rows[k] = colors[k].mask.ptr<uchar>(i);
+
+            for (int j = 0; j < hsv_image.cols; j++, p += 3) {
+
+                const int h = p[0], s = p[1], v = p[2];
+
+                // A pixel counts toward every color whose pass bands it is
+                // in, as it would for separate hsv detectors
+                for (size_t k = 0; k < n_colors; k++) {
+                    const Color& c = colors[k];
+                    const bool in = h >= c.h_min && h <= c.h_max &&
+                                    s >= c.s_min && s <= c.s_max &&
+                                    v >= c.v_min && v <= c.v_max;
+                    mask_rows[k][j] = in ? 255 : 0;
+                }
+            }
+        }
+    }
+
+    for (size_t k = 0; k < n_colors; k++)
+        findObject(colors[k], positions[k]);
+
+    // Not published. There is no SINK named after the prefix.
+    return oat::Position2D();
+}
+
+void MultiHSVDetector::findObject(Color& color, oat::Position2D& position) {
+
+    // Get rid of speckles, as hsv does
+    if (!color.erode_element.empty())
+        cv::erode(color.mask, color.mask, color.erode_element);
+
+    if (!color.dilate_element.empty())
+        cv::dilate(color.mask, color.mask, color.dilate_element);
+
+    // Largest blob within the area range
+    const Blob* object = nullptr;
+    for (const auto& blob : blob_labeler.label(color.mask)) {
+
+        const double area = blob.area();
+        if (area > color.min_area && 
+                (color.max_area <= 0 || area < color.max_area) &&
+                (!object || area > object->area())) {
+            object = &blob;
+        }
+    }
+
+    position.position_valid = object != nullptr;
+    if (object)
+        position.position = object->centroid();
+}
+
+void MultiHSVDetector::publishAuxiliary(const uint32_t sample_number) {
+
+    for (size_t k = 0; k < positions.size(); k++) {
+
+        oat::Position2D position = positions[k];
+        mapToFullFrame(position);
+        position_sinks[k]->pushObject(position, sample_number);
+    }
+}
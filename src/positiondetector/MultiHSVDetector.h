@@ -0,0 +1,96 @@
+//******************************************************************************
+//* File:   MultiHSVDetector.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef MULTIHSVDETECTOR_H
+#define	MULTIHSVDETECTOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "../../lib/utility/ColorLUT.h"
+
+#include "PositionDetector.h"
+#include "BlobLabeler.h"
+
+/**
+ * A color-based detector for several objects. Each pixel is classified
+ * against every color's thresholds in a single pass, by lookup table or after
+ * one conversion to HSV. Each color's mask is then eroded and dilated, and
+ * the position of its largest blob within its area range is published to
+ * its own SINK, SINK_<name>.
+ */
+class MultiHSVDetector : public PositionDetector {
+public:
+
+    /**
+     * A color-based detector for several objects.
+     * @param source_name Image SOURCE name
+     * @param pos_sink_name Prefix of position SINK names
+     */
+    MultiHSVDetector(const std::string& source_name, const std::string& pos_sink_name);
+
+    /**
+     * Detect the position of every color.
+     * @param frame frame to look for objects in.
+     * @return Unused. Positions are published by publishAuxiliary().
+     */
+    oat::Position2D detectPosition(cv::Mat& frame);
+
+    void configure(const std::string& config_file, const std::string& config_key);
+
+private:
+
+    // HSV pass bands, inclusive, morphology and the object area range of
+    // one color
+    struct Color {
+        std::string name;
+        int h_min {0}, h_max {255};
+        int s_min {0}, s_max {255};
+        int v_min {0}, v_max {255};
+        cv::Mat erode_element, dilate_element; // Empty if not used
+        double min_area {0.0};
+        double max_area {0.0}; // 0 for no maximum
+        cv::Mat mask;
+    };
+
+    const std::string sink_prefix;
+    std::vector<Color> colors;
+    std::vector<oat::Position2D> positions;
+    std::vector<std::unique_ptr<oat::SMServer<oat::Position2D>>> position_sinks;
+
+    cv::Mat hsv_image;
+
+    // Classify BGR pixels with a lookup table instead of converting frames
+    // to HSV. Bits per channel of the table index. 0 to convert each frame.
+    int lut_bits {8};
+    oat::ColorLUT color_lut;
+    cv::Mat class_image;
+
+    // Connected components of each color's mask
+    BlobLabeler blob_labeler;
+
+    // Clean up a color's mask and find its largest blob within range
+    void findObject(Color& color, oat::Position2D& position);
+
+    void publishAuxiliary(const uint32_t sample_number);
+};
+
+#endif	/* MULTIHSVDETECTOR_H */
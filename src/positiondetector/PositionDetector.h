@@ -20,15 +20,18 @@
 #ifndef POSITIONDETECTOR_H
 #define	POSITIONDETECTOR_H
 
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/Position2DArray.h"
 #include "../../lib/shmem/MatClient.h"
 #include "../../lib/shmem/SMServer.h"
-
-namespace oat {
-    class Position2D;
-}
+#include "../../lib/utility/OrderedWorkerPool.h"
+#include "../../lib/utility/PackedMask.h"
 
 /**
  * Abstract object position detector.
@@ -40,13 +43,21 @@ public:
     /**
      * Abstract object position detector.
      * All concrete object position detector types implement this ABC.
-     * @param image_source_name Frame SOURCE name
+     * @param image_source_name Frame SOURCE name. If empty, no SOURCE is
+     * created and the detector can only be used as a worker (see set_workers()).
      * @param position_sink_name Position SINK name
+     * @param use_sink If false, no SINK is created and the detector 
+     * publishes positions itself, through publishAuxiliary().
      */
-    PositionDetector(const std::string& image_source_name, const std::string& position_sink_name) :
+    PositionDetector(const std::string& image_source_name, 
+                     const std::string& position_sink_name,
+                     const bool use_sink = true) :
       name("posidet[" + image_source_name + "->" + position_sink_name + "]")
-    , frame_source(image_source_name)
-    , position_sink(position_sink_name) {
+    , position_sink_name(position_sink_name)
+    , use_sink(use_sink) { 
+
+        if (!image_source_name.empty())
+            frame_source.reset(new oat::MatClient(image_source_name));
     }
 
     virtual ~PositionDetector() { }
@@ -58,15 +69,51 @@ public:
      */
     bool process(void) {
 
-        // If we are able to get a an image
-        if (frame_source.getSharedMat(current_frame)) {
+        if (worker_pool)
+            return processParallel();
 
-            position_sink.pushObject(detectPosition(current_frame), 
-                                     frame_source.get_current_sample_number());
+        // If we are able to get a an image
+        if (readSample(current)) {
+            detect(current);
+            publish(current);
         }
         
         // If server state is END, return true
-        return (frame_source.getSourceRunState() == oat::ServerRunState::END);
+        return (frame_source->getSourceRunState() == oat::ServerRunState::END);
+    }
+
+    /**
+     * Detect positions on several threads. Consecutive frames are given to
+     * the workers in turn, and positions are published in sample order. Each
+     * worker keeps its own state, so stateful detectors (e.g. diff) and
+     * search windows only see every K-th frame.
+     * @param workers K detectors, configured like this one and created without
+     * SOURCE. This detector's own detection functions are not used.
+     */
+    void set_workers(const std::vector<std::shared_ptr<PositionDetector>>& workers) {
+
+        worker_detectors = workers;
+        worker_pool.reset(new WorkerPool(workers.size(),
+            [this](const size_t w, Sample& s) {
+                worker_detectors[w]->detect(s);
+                return s;
+            }));
+    }
+
+    /**
+     * Create SINK. Its type depends on get_max_objects(), so this is called
+     * once configure() has run and before the first frame is processed.
+     * Does nothing for detectors created without SINK.
+     */
+    void connectSink(void) {
+
+        if (!use_sink)
+            return;
+
+        if (max_objects > 0)
+            array_sink.reset(new oat::SMServer<oat::Position2DArray>(position_sink_name));
+        else
+            position_sink.reset(new oat::SMServer<oat::Position2D>(position_sink_name));
     }
 
     /**
@@ -90,20 +137,191 @@ protected:
      * @return detected object position.
      */
     virtual oat::Position2D detectPosition(cv::Mat& frame) = 0;
+
+    /**
+     * Perform detection of up to get_max_objects() objects. Used instead of
+     * detectPosition() when get_max_objects() is greater than 0. By default,
+     * reports the single position found by detectPosition(), if it is valid.
+     * @param frame frame to look for objects in.
+     * @param positions Detected object positions.
+     */
+    virtual void detectPositions(cv::Mat& frame, oat::Position2DArray& positions) {
+
+        positions.clear();
+
+        oat::Position2D position = detectPosition(frame);
+        if (position.position_valid)
+            positions.push_back(position);
+    }
+
+    /**
+     * Publish a Position2DArray holding up to this many positions to SINK
+     * instead of a single Position2D. SINK is created by connectSink(), so
+     * this must be set before then.
+     * @param value Maximum number of positions per frame. 0 to publish single
+     * positions.
+     */
+    void set_max_objects(const size_t value) {
+
+        if (value > oat::Position2DArray::CAPACITY) {
+            throw (std::runtime_error("At most " 
+                    + std::to_string(oat::Position2DArray::CAPACITY) 
+                    + " objects can be detected per frame."));
+        }
+
+        max_objects = value;
+    }
+
+    size_t get_max_objects(void) const { return max_objects; }
+
+    /**
+     * Get the width of the current frame if it is a bit packed mask (see
+     * PackedMask.h).
+     * @return Width in pixels. 0 if the frame is not packed.
+     */
+    int current_packed_width(void) const { return current.packed_width; }
+
+    /**
+     * Detectors that can find objects in bit packed masks override this.
+     * Others reject frames from SOURCEs that publish them.
+     * @return true if packed masks are accepted.
+     */
+    virtual bool accepts_packed_masks(void) const { return false; }
+
+    /**
+     * Frames that were cropped or downsampled upstream carry their mapping to
+     * the full frame. Positions are reported in full frame coordinates.
+     * @param position Position detected in the current frame. Converted to 
+     * full frame coordinates in place.
+     */
+    void mapToFullFrame(oat::Position2D& position) const {
+
+        if (position.position_valid) {
+            position.position = current.offset + current.scale * position.position;
+        }
+    }
+
+    /**
+     * Publish positions to SINKs other than SINK. Called after each frame is
+     * processed.
+     * @param sample_number Sample number of the current frame.
+     */
+    virtual void publishAuxiliary(const uint32_t sample_number) { }
     
     // Detector name
     const std::string name;
  
 private:
 
+    // A frame and its detected positions
+    struct Sample {
+        cv::Mat frame;
+        uint32_t sample {0};
+        cv::Point2d offset;
+        double scale {1.0};
+        int packed_width {0};
+        oat::Position2D position;
+        oat::Position2DArray positions;
+    };
+
     // Current frame
-    cv::Mat current_frame;
+    Sample current;
 
     // Frame SOURCE object for receiving frames
-    oat::MatClient frame_source;
+    std::unique_ptr<oat::MatClient> frame_source;
+
+    // Position SINK object for publishing detected positions. Created by
+    // connectSink(), once its type is known.
+    const std::string position_sink_name;
+    const bool use_sink;
+    std::unique_ptr<oat::SMServer<oat::Position2D>> position_sink;
+
+    // Multiple object detection
+    size_t max_objects {0};
+    std::unique_ptr<oat::SMServer<oat::Position2DArray>> array_sink;
+
+    // Frame parallel detection
+    using WorkerPool = oat::OrderedWorkerPool<Sample, Sample>;
+    std::vector<std::shared_ptr<PositionDetector>> worker_detectors;
+    std::unique_ptr<WorkerPool> worker_pool;
+
+    // Get the next frame and its metadata from SOURCE
+    bool readSample(Sample& s) {
+
+        if (!frame_source->getSharedMat(s.frame))
+            return false;
+
+        s.sample = frame_source->get_current_sample_number();
+        s.offset = frame_source->get_current_offset();
+        s.scale = frame_source->get_current_scale();
+        s.packed_width = frame_source->get_current_packed_width();
+
+        if (s.packed_width > 0 && !accepts_packed_masks())
+            throw (std::runtime_error(oat::packed::sourceError(frame_source->get_name())));
+
+        return true;
+    }
+
+    // Detect positions in s.frame, in full frame coordinates
+    void detect(Sample& s) {
+
+        // Frame metadata used by current_packed_width() and mapToFullFrame()
+        if (&s != &current) {
+            current.offset = s.offset;
+            current.scale = s.scale;
+            current.packed_width = s.packed_width;
+        }
+
+        if (max_objects > 0) {
+            detectPositions(s.frame, s.positions);
+            for (auto& p : s.positions)
+                mapToFullFrame(p);
+        } else {
+            s.position = detectPosition(s.frame);
+            mapToFullFrame(s.position);
+        }
+    }
+
+    void publish(const Sample& s) {
+
+        if (use_sink) {
+
+            if (max_objects > 0)
+                array_sink->pushObject(s.positions, s.sample);
+            else
+                position_sink->pushObject(s.position, s.sample);
+        }
+
+        publishAuxiliary(s.sample);
+    }
+
+    bool processParallel(void) {
+
+        Sample s;
+        if (readSample(s)) {
 
-    // Position SINK object for publishing detected positions
-    oat::SMServer<oat::Position2D> position_sink;
+            // Make room by waiting for the oldest frame in flight
+            if (worker_pool->full())
+                publish(worker_pool->pop());
+
+            worker_pool->push(std::move(s));
+        }
+
+        // Publish whatever has finished, in order, without waiting
+        Sample done;
+        while (worker_pool->tryPop(done))
+            publish(done);
+
+        if (frame_source->getSourceRunState() == oat::ServerRunState::END) {
+
+            while (worker_pool->in_flight() > 0)
+                publish(worker_pool->pop());
+
+            return true;
+        }
+
+        return false;
+    }
 };
 
 #endif	/* POSITIONDETECTOR_H */
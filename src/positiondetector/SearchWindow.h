@@ -0,0 +1,131 @@
+//******************************************************************************
+//* File:   SearchWindow.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu) 
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef SEARCHWINDOW_H
+#define	SEARCHWINDOW_H
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+
+/**
+ * Restricts detection to a window around the predicted object position.
+ * The prediction is the last detected position plus the velocity between the
+ * last two detections. Each miss doubles the window size. Once the window
+ * covers the frame, the object is considered lost and the whole frame is
+ * searched until it is found again.
+ */
+class SearchWindow {
+public:
+
+    /**
+     * Set the window size.
+     * @param size Width and height of the window when the object is being
+     * tracked (pixels). 0 to always search the whole frame.
+     */
+    void set_size(const int size) {
+        base_size = size;
+        reset();
+    }
+
+    bool enabled(void) const { return base_size > 0; }
+
+    /**
+     * Get the region of the next frame to search.
+     * @param frame_size Size of the frame.
+     * @return Search region, clipped to the frame.
+     */
+    cv::Rect region(const cv::Size& frame_size) {
+
+        const cv::Rect full(0, 0, frame_size.width, frame_size.height);
+        frame_extent = std::max(frame_size.width, frame_size.height);
+        if (!enabled() || !tracking)
+            return full;
+
+        // Coast along the last velocity for each missed sample
+        const cv::Point2d center = last_position + (1 + misses) * velocity;
+        const int half = current_size / 2;
+
+        cv::Rect r(static_cast<int>(std::lround(center.x)) - half, 
+                   static_cast<int>(std::lround(center.y)) - half, 
+                   current_size, current_size);
+        r &= full;
+
+        // Lost: the prediction left the frame or the window covers it
+        if (r.area() == 0 || r == full) {
+            reset();
+            r = full;
+        }
+
+        return r;
+    }
+
+    /**
+     * Update the prediction with the result of searching the last region
+     * returned by region().
+     * @param position Detected position, in frame coordinates.
+     */
+    void update(const oat::Position2D& position) {
+
+        if (!enabled())
+            return;
+
+        if (position.position_valid) {
+
+            velocity = tracking && misses == 0 ? 
+                    position.position - last_position : cv::Point2d(0, 0);
+            last_position = position.position;
+            tracking = true;
+            misses = 0;
+            current_size = base_size;
+
+        } else if (tracking) {
+
+            misses++;
+            current_size *= 2;
+
+            // A window twice the frame's extent covers it from anywhere in
+            // the frame. Also bounds the size when region() is not called.
+            if (current_size >= 2 * frame_extent)
+                reset();
+        }
+    }
+
+private:
+
+    int base_size {0};
+    int current_size {0};
+    int frame_extent {0};
+
+    bool tracking {false};
+    int misses {0};
+    oat::Point2D last_position;
+    oat::Velocity2D velocity;
+
+    void reset(void) {
+        tracking = false;
+        misses = 0;
+        current_size = base_size;
+        velocity = cv::Point2d(0, 0);
+    }
+};
+
+#endif	/* SEARCHWINDOW_H */
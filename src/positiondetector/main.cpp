@@ -22,13 +22,17 @@
 #include <iostream>
 #include <csignal>
 #include <unordered_map>
+#include <vector>
 #include <boost/program_options.hpp>
 
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/cpptoml/cpptoml.h"
+#include "../../lib/cpptoml/OatTOMLSanitize.h"
 
 #include "PositionDetector.h"
 #include "HSVDetector.h"
+#include "BinaryDetector.h"
+#include "MultiHSVDetector.h"
 #include "DifferenceDetector.h"
 
 namespace po = boost::program_options;
@@ -43,7 +47,11 @@ void printUsage(po::options_description options) {
               << "Publish detected object positions to SINK.\n\n"
               << "TYPE\n"
               << "  diff: Difference detector (grey-scale, motion)\n"
-              << "  hsv : HSV detector (color)\n\n"
+              << "  hsv : HSV detector (color)\n"
+              << "  binary: Centroid of a binary mask (e.g. from framefilt "
+              << "threshold)\n"
+              << "  multihsv: HSV detector for several colors, published to "
+              << "SINK_<color>\n\n"
               << "SOURCE:\n"
               << "  User-supplied name of the memory segment to receive frames "
               << "from (e.g. raw).\n\n"
@@ -58,6 +66,20 @@ void sigHandler(int s) {
     quit = 1;
 }
 
+// Create a detector of the given TYPE. Returns nullptr if TYPE is invalid.
+std::shared_ptr<PositionDetector> createDetector(const char type,
+                                                 const std::string& source,
+                                                 const std::string& sink) {
+
+    switch (type) {
+        case 'a': return std::make_shared<DifferenceDetector2D>(source, sink);
+        case 'b': return std::make_shared<HSVDetector>(source, sink);
+        case 'c': return std::make_shared<BinaryDetector>(source, sink);
+        case 'd': return std::make_shared<MultiHSVDetector>(source, sink);
+        default: return nullptr;
+    }
+}
+
 // Processing loop
 void run(const std::shared_ptr<PositionDetector>& detector) {
 
@@ -76,11 +98,14 @@ int main(int argc, char *argv[]) {
     std::string config_file;
     std::string config_key;
     bool config_used = false;
+    int num_workers = 1;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
     type_hash["diff"] = 'a';
     type_hash["hsv"] = 'b';
+    type_hash["binary"] = 'c';
+    type_hash["multihsv"] = 'd';
 
     try {
 
@@ -94,6 +119,13 @@ int main(int argc, char *argv[]) {
         config.add_options()
                 ("config-file,c", po::value<std::string>(&config_file), "Configuration file.")
                 ("config-key,k", po::value<std::string>(&config_key), "Configuration key.")
+                ("workers,w", po::value<int>(&num_workers),
+                "Detect positions on this many threads, each with its own copy "
+                "of the detector. Frames are handed to the threads in turn and "
+                "positions are published in order. Stateful detectors (diff, "
+                "search windows) keep one state per thread, each updated from "
+                "every N-th frame. Not supported by TYPE=multihsv or with tune = true. "
+                "Defaults to 1.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -101,7 +133,9 @@ int main(int argc, char *argv[]) {
                 ("type,t", po::value<std::string>(&type), "Detector type.\n\n"
                 "Values:\n"
                 "  diff: Difference detector (motion).\n"
-                "  hsv: HSV detector (color).")
+                "  hsv: HSV detector (color).\n"
+                "  binary: Binary mask centroid.\n"
+                "  multihsv: HSV detector for several colors.")
                 ("source", po::value<std::string>(&source),
                 "The name of the SOURCE that supplies images on which hsv-filter object detection will be performed."
                 "The server must be of type SMServer<SharedCVMatHeader>\n")
@@ -172,6 +206,26 @@ int main(int argc, char *argv[]) {
             config_used = true;
         }
 
+        if (type.compare("multihsv") == 0 && !config_used) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("TYPE=multihsv requires a configuration file "
+                    "that specifies its colors.\n");
+            return -1;
+        }
+
+        if (num_workers < 1) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("The number of workers must be at least 1.\n");
+            return -1;
+        }
+
+        if (num_workers > 1 && type.compare("multihsv") == 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("TYPE=multihsv publishes several streams per "
+                    "frame and cannot use workers.\n");
+            return -1;
+        }
+
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
         return -1;
@@ -181,34 +235,51 @@ int main(int argc, char *argv[]) {
     }
 
     // Create component
-    std::shared_ptr<PositionDetector> detector;
-    
-    // Refine component type
-    switch (type_hash[type]) {
-        case 'a':
-        {
-            detector = std::make_shared<DifferenceDetector2D>(source, sink);
-            break;
-        }
-        case 'b':
-        {
-            detector = std::make_shared<HSVDetector>(source, sink);
-            break;
-        }
-        default:
-        {
-            printUsage(visible_options);
-            std::cerr << oat::Error("Invalid TYPE specified.\n");
-            return -1;
-        }
+    std::shared_ptr<PositionDetector> detector = 
+        createDetector(type_hash[type], source, sink);
+
+    if (!detector) {
+        printUsage(visible_options);
+        std::cerr << oat::Error("Invalid TYPE specified.\n");
+        return -1;
     }
 
     // The business
     try {
 
+        // Tuning windows are created by configure() and drawn from the
+        // detection thread. HighGUI is not thread safe, so they cannot be
+        // used by several workers.
+        if (num_workers > 1 && config_used) {
+
+            cpptoml::table config = cpptoml::parse_file(config_file);
+            bool tune = false;
+            if (config.contains(config_key))
+                oat::config::getValue(config.get_table(config_key), "tune", tune);
+
+            if (tune)
+                throw (std::runtime_error("Tuning is not supported with more than one worker.\n"));
+        }
+
         if (config_used)
             detector->configure(config_file, config_key);
 
+        // Worker copies have no SOURCE or SINK of their own
+        if (num_workers > 1) {
+
+            std::vector<std::shared_ptr<PositionDetector>> workers;
+            for (int i = 0; i < num_workers; i++) {
+                workers.push_back(createDetector(type_hash[type], "", ""));
+                if (config_used)
+                    workers.back()->configure(config_file, config_key);
+            }
+
+            detector->set_workers(workers);
+        }
+
+        // SINK type is known once max_objects has been configured
+        detector->connectSink();
+
         // Tell user
         std::cout << oat::whoMessage(detector->get_name(),
                 "Listening to source " + oat::sourceText(source) + ".\n")
@@ -23,8 +23,10 @@
 #include "../../lib/cpptoml/OatTOMLSanitize.h"
 #include "../../lib/utility/IOFormat.h"
 
-HomographyTransform2D::HomographyTransform2D(const std::string& position_source_name, const std::string& position_sink_name) :
-PositionFilter(position_source_name, position_sink_name)
+HomographyTransform2D::HomographyTransform2D(const std::string& position_source_name, 
+        const std::string& position_sink_name,
+        const bool arrays) :
+PositionFilter(position_source_name, position_sink_name, arrays)
 , homography_valid(false)
 , homography(1.0, 0, 0, 0, 1.0, 0, 0, 0, 1.0) { }
 
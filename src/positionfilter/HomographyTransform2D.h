@@ -37,8 +37,11 @@ public:
      * to map pixels coordinates to world coordinates. 
      * @param position_source_name Un-filtered position SOURCE name
      * @param position_sink_name Filtered position SINK name
+     * @param arrays Filter each position of position arrays
      */
-    HomographyTransform2D(const std::string& position_source_name, const std::string& position_sink_name);
+    HomographyTransform2D(const std::string& position_source_name, 
+            const std::string& position_sink_name,
+            const bool arrays = false);
 
     void configure(const std::string& config_file, const std::string& config_key);
 
@@ -20,9 +20,12 @@
 #ifndef POSITIONFILTER_H
 #define	POSITIONFILTER_H
 
+#include <memory>
+
 #include "../../lib/shmem/SMServer.h"
 #include "../../lib/shmem/SMClient.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/Position2DArray.h"
 
 /**
  * Abstract position filter.
@@ -36,14 +39,22 @@ public:
      * All concrete position filter types implement this ABC.
      * @param position_source_name Un-filtered position SOURCE name
      * @param position_sink_name Filtered position SINK name
+     * @param arrays SOURCE publishes position arrays. Each position in an
+     * array is filtered, and the filtered array is published to SINK.
      */
-    PositionFilter(const std::string& position_source_name, const std::string& position_sink_name) :
+    PositionFilter(const std::string& position_source_name, 
+                   const std::string& position_sink_name,
+                   const bool arrays = false) :
       name("posifilt[" + position_source_name + "->" + position_sink_name + "]")
     , position(position_source_name)
-    , position_source(position_source_name)
-    , position_sink(position_sink_name) 
     { 
-        // Nothing   
+        if (arrays) {
+            array_source.reset(new oat::SMClient<oat::Position2DArray>(position_source_name));
+            array_sink.reset(new oat::SMServer<oat::Position2DArray>(position_sink_name));
+        } else {
+            position_source.reset(new oat::SMClient<oat::Position2D>(position_source_name));
+            position_sink.reset(new oat::SMServer<oat::Position2D>(position_sink_name));
+        }
     }
 
 
@@ -56,15 +67,29 @@ public:
      */
     bool process(void) {
 
-        if (position_source.getSharedObject(position)) {
+        if (array_source) {
+
+            if (array_source->getSharedObject(positions)) {
+
+                for (auto& p : positions)
+                    p = filterPosition(p);
+
+                array_sink->pushObject(positions, 
+                                       array_source->get_current_time_stamp());
+            }
+
+            return (array_source->getSourceRunState() == oat::ServerRunState::END);  
+        }
+
+        if (position_source->getSharedObject(position)) {
             
-            position_sink.pushObject(filterPosition(position), 
-                                     position_source.get_current_time_stamp());
+            position_sink->pushObject(filterPosition(position), 
+                                      position_source->get_current_time_stamp());
    
         }
         
         // If server state is END, return true
-        return (position_source.getSourceRunState() == oat::ServerRunState::END);  
+        return (position_source->getSourceRunState() == oat::ServerRunState::END);  
     }
 
     /**
@@ -92,13 +117,19 @@ private:
     const std::string name;
     
     // Un-filtered position SOURCE object
-    oat::SMClient<oat::Position2D> position_source;
+    std::unique_ptr<oat::SMClient<oat::Position2D>> position_source;
     
     // Un-filtered position
     oat::Position2D position;
     
     // Filtered position SINK object
-    oat::SMServer<oat::Position2D> position_sink;
+    std::unique_ptr<oat::SMServer<oat::Position2D>> position_sink;
+
+    // Position array SOURCE, array and SINK, used instead of the above when
+    // filtering position arrays
+    std::unique_ptr<oat::SMClient<oat::Position2DArray>> array_source;
+    oat::Position2DArray positions;
+    std::unique_ptr<oat::SMServer<oat::Position2DArray>> array_sink;
 };
 
 #endif	/* POSITIONFILTER_H */
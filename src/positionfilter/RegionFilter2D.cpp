@@ -28,8 +28,10 @@
 #include "../../lib/cpptoml/OatTOMLSanitize.h"
 #include "../../lib/utility/IOFormat.h"
 
-RegionFilter2D::RegionFilter2D(const std::string& position_source_name, const std::string& position_sink_name) :
-  PositionFilter(position_source_name, position_sink_name)
+RegionFilter2D::RegionFilter2D(const std::string& position_source_name, 
+        const std::string& position_sink_name,
+        const bool arrays) :
+  PositionFilter(position_source_name, position_sink_name, arrays)
 , regions_configured(false) { }
 
 RegionFilter2D::~RegionFilter2D() {
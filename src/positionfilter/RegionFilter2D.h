@@ -39,8 +39,11 @@ public:
      * to the position. 
      * @param position_source_name Position SOURCE name
      * @param position_sink_name Filtered position SINK name
+     * @param arrays Filter each position of position arrays
      */
-    RegionFilter2D(const std::string& position_source_name, const std::string& position_sink_name);
+    RegionFilter2D(const std::string& position_source_name, 
+            const std::string& position_sink_name,
+            const bool arrays = false);
     ~RegionFilter2D();
 
     void configure(const std::string& config_file, const std::string& config_key);
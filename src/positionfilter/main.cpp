@@ -77,6 +77,7 @@ int main(int argc, char *argv[]) {
     std::string config_file;
     std::string config_key;
     bool config_used = false;
+    bool arrays = false;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
@@ -96,6 +97,9 @@ int main(int argc, char *argv[]) {
         config.add_options()
                 ("config-file,c", po::value<std::string>(&config_file), "Configuration file.")
                 ("config-key,k", po::value<std::string>(&config_key), "Configuration key.")
+                ("arrays,a", "SOURCE publishes position arrays (e.g. posidet hsv with "
+                "max_objects > 0). Each position in the array is filtered. Not "
+                "supported by TYPE=kalman.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -162,6 +166,17 @@ int main(int argc, char *argv[]) {
             return -1;
         }
         
+        if (variable_map.count("arrays")) {
+            arrays = true;
+        }
+
+        if (arrays && type.compare("kalman") == 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("TYPE=kalman tracks a single position and cannot "
+                         "filter position arrays.\n");
+            return -1;
+        }
+
         if (!variable_map.count("config-file") && type.compare("homo") == 0) {
             printUsage(visible_options);
             std::cerr << oat::Error("When TYPE=homo, a configuration file must be specified"
@@ -201,12 +216,12 @@ int main(int argc, char *argv[]) {
             }
             case 'b':
             {
-                filter = std::make_shared<HomographyTransform2D>(source, sink);
+                filter = std::make_shared<HomographyTransform2D>(source, sink, arrays);
                 break;
             }
             case 'c':
             {
-                filter = std::make_shared<RegionFilter2D>(source, sink);
+                filter = std::make_shared<RegionFilter2D>(source, sink, arrays);
                 break;
             }
             default:
@@ -21,7 +21,6 @@
 #include <limits>
 #include <math.h>
 #include <string>
-#include <thread>
 #include <opencv2/opencv.hpp>
 
 #include "../../lib/cpptoml/cpptoml.h"
@@ -94,9 +93,7 @@ oat::Position2D RandomAccel2D::generatePosition( ) {
     pos.velocity.y = state(3);
     
     // Enforce sample period
-    auto tock = clock.now();
-    std::this_thread::sleep_for(sample_period_in_sec - (tock - tick));
-    tick = clock.now();
+    pacer.wait();
     
     return pos;
 }
@@ -113,7 +110,7 @@ void RandomAccel2D::simulateMotion() {
 
 void RandomAccel2D::createStaticMatracies( ) {
     
-    double Ts = sample_period_in_sec.count();
+    double Ts = sample_period_in_sec;
     
     // State transition matrix
     state_transition_mat(0, 0) = 1.0;
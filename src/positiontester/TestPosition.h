@@ -20,13 +20,14 @@
 #ifndef TESTPOSITION_H
 #define	TESTPOSITION_H
 
-#include <chrono>
 #include <string>
 #include <random>
 #include <opencv2/core/mat.hpp>
 
 #include "../../lib/datatypes/Position.h"
 #include "../../lib/shmem/BufferedSMServer.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/Pacer.h"
 
 /**
  * Abstract test position server.
@@ -51,10 +52,14 @@ public:
     , sample(0) { 
 
         generateSamplePeriod(samples_per_second);
-        tick = clock.now();
     }
       
-    virtual ~TestPosition() { }
+    virtual ~TestPosition() {
+
+#ifndef NDEBUG
+        std::cout << oat::dbgMessage("Sample pacing: " + pacer.report() + "\n");
+#endif
+    }
 
     /**
      * Generate test position. Publish test position to SINK.
@@ -91,9 +96,8 @@ protected:
     virtual T generatePosition(void) = 0;
     
     // Test position sample clock
-    std::chrono::high_resolution_clock clock;
-    std::chrono::duration<double> sample_period_in_sec;
-    std::chrono::high_resolution_clock::time_point tick;
+    oat::Pacer pacer;
+    double sample_period_in_sec;
     
     /**
      * Configure the sample period
@@ -101,10 +105,8 @@ protected:
      */
     void generateSamplePeriod(const double samples_per_second) {
 
-        std::chrono::duration<double> period{1.0 / samples_per_second};
-
-        // Automatic conversion
-        sample_period_in_sec = period;
+        sample_period_in_sec = 1.0 / samples_per_second;
+        pacer.set_rate(samples_per_second);
     }    
         
 private:
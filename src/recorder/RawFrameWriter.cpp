@@ -0,0 +1,120 @@
+//******************************************************************************
+//* File:   RawFrameWriter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <stdexcept>
+
+#include "RawFrameWriter.h"
+
+RawFrameWriter::RawFrameWriter(const std::string& file_name, const double frame_rate) :
+  file_name(file_name)
+, fp(nullptr)
+, write_buffer(1 << 22) {
+
+    header.frame_rate = frame_rate;
+}
+
+RawFrameWriter::~RawFrameWriter() {
+
+    // Errors cannot be reported from here. Call release() to check for them.
+    try {
+        release();
+    } catch (const std::runtime_error&) { }
+}
+
+void RawFrameWriter::write(const uint64_t sample, const cv::Mat& frame) {
+
+    // Frame geometry is taken from the first frame
+    if (!fp) {
+
+        fp = fopen(file_name.c_str(), "wb");
+        if (!fp)
+            throw (std::runtime_error("Unable to open " + file_name + "."));
+
+        // Large writes keep the disk, rather than the writer, the bottleneck
+        setvbuf(fp, write_buffer.data(), _IOFBF, write_buffer.size());
+
+        header.rows = frame.rows;
+        header.cols = frame.cols;
+        header.type = frame.type();
+        header.frame_bytes = frame.total() * frame.elemSize();
+
+        // Placeholder header with no frames. Rewritten when the file is
+        // closed.
+        if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+                fseek(fp, header.data_offset, SEEK_SET) != 0) {
+            fail();
+        }
+    }
+
+    if (frame.rows != static_cast<int>(header.rows) ||
+            frame.cols != static_cast<int>(header.cols) ||
+            frame.type() != header.type) {
+        throw (std::runtime_error("Frame size or type changed while writing "
+                + file_name + "."));
+    }
+
+    if (frame.isContinuous()) {
+        if (fwrite(frame.data, 1, header.frame_bytes, fp) != header.frame_bytes)
+            fail();
+    } else {
+        size_t row_bytes = frame.cols * frame.elemSize();
+        for (int i = 0; i < frame.rows; i++) {
+            if (fwrite(frame.ptr(i), 1, row_bytes, fp) != row_bytes)
+                fail();
+        }
+    }
+
+    samples.push_back(sample);
+}
+
+void RawFrameWriter::release() {
+
+    if (!fp)
+        return;
+
+    header.count = samples.size();
+    header.index_offset = header.data_offset + header.count * header.frame_bytes;
+
+    // Sample index follows the frames. The header, which makes the frames
+    // and index readable, is only written once they are all on disk.
+    if (fseek(fp, header.index_offset, SEEK_SET) != 0 ||
+            fwrite(samples.data(), sizeof(uint64_t), samples.size(), fp) != samples.size() ||
+            fflush(fp) != 0) {
+        fail();
+    }
+
+    if (fseek(fp, 0, SEEK_SET) != 0 ||
+            fwrite(&header, sizeof(header), 1, fp) != 1) {
+        fail();
+    }
+
+    FILE* f = fp;
+    fp = nullptr;
+    if (fclose(f) != 0)
+        throw (std::runtime_error("Unable to write " + file_name + "."));
+}
+
+void RawFrameWriter::fail() {
+
+    // The placeholder header has no frames, so a partially written file is
+    // never mistaken for a complete one
+    fclose(fp);
+    fp = nullptr;
+    throw (std::runtime_error("Unable to write " + file_name + "."));
+}
@@ -0,0 +1,73 @@
+//******************************************************************************
+//* File:   RawFrameWriter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef RAWFRAMEWRITER_H
+#define RAWFRAMEWRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "../../lib/utility/RawFrameFormat.h"
+
+/**
+ * Writes uncompressed frames, along with their sample numbers, to a raw frame
+ * file that can be served by frameserve TYPE=raw.
+ */
+class RawFrameWriter {
+public:
+
+    /**
+     * Raw frame file writer.
+     * @param file_name Path of file to create.
+     * @param frame_rate Frame rate stored in the file header (Hz).
+     */
+    RawFrameWriter(const std::string& file_name, const double frame_rate);
+
+    ~RawFrameWriter();
+
+    /**
+     * Append a frame. All frames must have the same size and type. Throws
+     * std::runtime_error, and closes the file, if it cannot be written.
+     * @param sample Sample number of frame.
+     * @param frame Frame to write.
+     */
+    void write(const uint64_t sample, const cv::Mat& frame);
+
+    /**
+     * Write the sample index and final header, and close the file. Throws
+     * std::runtime_error if the file cannot be written. The header is
+     * written last, so an incomplete file reads as holding no frames.
+     */
+    void release(void);
+
+private:
+
+    std::string file_name;
+    FILE* fp;
+    oat::RawFrameHeader header;
+    std::vector<uint64_t> samples;
+    std::vector<char> write_buffer;
+
+    // Close the file and throw after a failed write
+    void fail(void);
+};
+
+#endif // RAWFRAMEWRITER_H
@@ -20,6 +20,7 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <iostream>
 #include <mutex>
 #include <vector>
 
@@ -27,6 +28,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/dynamic_bitset.hpp>
 
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/PackedMask.h"
 #include "../../lib/utility/make_unique.h"
 
 #include "Recorder.h"
@@ -34,22 +37,28 @@
 namespace bfs = boost::filesystem;
 
 Recorder::Recorder(const std::vector<std::string>& position_source_names,
+        const std::vector<std::string>& position_array_source_names,
         const std::vector<std::string>& frame_source_names,
         std::string save_path,
         std::string file_name,
         const bool prepend_date,
         const int frames_per_second,
-        bool overwrite) :
+        bool overwrite,
+        bool raw_video) :
   save_path(save_path)
 , file_name(file_name)
 , append_date(prepend_date)
 , allow_overwrite(overwrite)
 , running(true)
 , frames_per_second(frames_per_second)
+, raw_video(raw_video)
+, position_fp(nullptr)
 , number_of_frame_sources(frame_source_names.size())
 , frame_read_required(number_of_frame_sources)
 , number_of_position_sources(position_source_names.size())
 , position_read_required(number_of_position_sources)
+, number_of_array_sources(position_array_source_names.size())
+, array_read_required(number_of_array_sources)
 , sources_eof(false) {
 
     // First check that the save_path is valid
@@ -73,11 +82,17 @@ Recorder::Recorder(const std::vector<std::string>& position_source_names,
     std::strftime(buffer, 80, "%F-%H-%M-%S", time_info);
     std::string date_now = std::string(buffer);
 
+    // Single positions and position arrays are written to the same file
+    std::vector<std::string> all_position_names(position_source_names);
+    all_position_names.insert(all_position_names.end(),
+            position_array_source_names.begin(), 
+            position_array_source_names.end());
+
     // Setup position sources
-    if (!position_source_names.empty()) {
+    if (!all_position_names.empty()) {
 
-        name += position_source_names[0];
-        if (position_source_names.size() > 1)
+        name += all_position_names[0];
+        if (all_position_names.size() > 1)
             name += "..";
         
         for (auto &s : position_source_names) {
@@ -86,15 +101,21 @@ Recorder::Recorder(const std::vector<std::string>& position_source_names,
             source_positions.push_back(std::make_unique<oat::Position2D>());
         }
 
+        for (auto &s : position_array_source_names) {
+
+            array_sources.push_back(std::make_unique<oat::SMClient< oat::Position2DArray> >(s));
+            source_arrays.push_back(std::make_unique<oat::Position2DArray>());
+        }
+
         // Create a single position file
         std::string posi_fid;
         if (prepend_date)
             posi_fid = file_name.empty() ?
-            (save_path + "/" + date_now + "_" + position_source_names[0]) :
+            (save_path + "/" + date_now + "_" + all_position_names[0]) :
             (save_path + "/" + date_now + "_" + file_name);
         else
             posi_fid = file_name.empty() ?
-            (save_path + "/" + position_source_names[0]) :
+            (save_path + "/" + all_position_names[0]) :
             (save_path + "/" + file_name);
 
         posi_fid = posi_fid + ".json";
@@ -122,7 +143,8 @@ Recorder::Recorder(const std::vector<std::string>& position_source_names,
         
         // Complete header object
         json_writer.String("header");
-        writePositionFileHeader(date_now, frames_per_second, position_source_names);
+        writePositionFileHeader(date_now, frames_per_second, 
+                position_source_names, position_array_source_names);
         
         // Start data object
         json_writer.String("positions");
@@ -133,7 +155,7 @@ Recorder::Recorder(const std::vector<std::string>& position_source_names,
     uint32_t idx = 0;
     if (!frame_source_names.empty()) {
 
-        if (!position_source_names.empty()) 
+        if (!all_position_names.empty()) 
             name += ", ";
         
         name += frame_source_names[0];
@@ -153,7 +175,7 @@ Recorder::Recorder(const std::vector<std::string>& position_source_names,
                 (save_path + "/" + frame_source_name) :
                 (save_path + "/" + file_name);
 
-            frame_fid = frame_fid + ".avi";
+            frame_fid = frame_fid + (raw_video ? ".raw" : ".avi");
 
             if (!allow_overwrite) {
                 checkFile(frame_fid);
@@ -164,9 +186,14 @@ Recorder::Recorder(const std::vector<std::string>& position_source_names,
             
             frame_write_buffers.push_back(
                 std::make_unique< boost::lockfree::spsc_queue
-                                < cv::Mat, boost::lockfree::capacity 
+                                < std::pair<uint32_t, cv::Mat>, boost::lockfree::capacity 
                                 < FRAME_WRITE_BUFFER_SIZE> > >());
-            video_writers.push_back(std::make_unique<cv::VideoWriter>());
+
+            if (raw_video)
+                raw_writers.push_back(
+                    std::make_unique<RawFrameWriter>(frame_fid, frames_per_second));
+            else
+                video_writers.push_back(std::make_unique<cv::VideoWriter>());
 
 
             // Spawn frame writer threads and synchronize to incoming data
@@ -180,6 +207,7 @@ Recorder::Recorder(const std::vector<std::string>& position_source_names,
     
     frame_read_required.set();
     position_read_required.set();
+    array_read_required.set();
     
     name +="]";
 }
@@ -197,6 +225,16 @@ Recorder::~Recorder() {
         value->join();
     }
 
+    // Finish raw files. A write error leaves a file that reads as empty.
+    for (auto &writer : raw_writers) {
+        try {
+            if (writer)
+                writer->release();
+        } catch (const std::runtime_error& ex) {
+            std::cerr << oat::whoError(name, ex.what()) << "\n";
+        }
+    }
+
     // Flush the position writer
     if (position_fp) {
         json_writer.EndArray();
@@ -219,6 +257,12 @@ bool Recorder::writeStreams() {
         sources_eof |= (position_sources[i]->getSourceRunState()
                 == oat::ServerRunState::END);
     }
+
+    for (int i = 0; i < number_of_array_sources; i++) {
+
+        sources_eof |= (array_sources[i]->getSourceRunState()
+                == oat::ServerRunState::END);
+    }
     
     boost::dynamic_bitset<>::size_type i = frame_read_required.find_first();
     
@@ -229,9 +273,16 @@ bool Recorder::writeStreams() {
         frame_read_required[i] = !frame_sources[i]->getSharedMat(current_frame);
 
         if (!frame_read_required[i]) {
+
+            // Video files and raw frame files hold pixels
+            if (frame_sources[i]->get_current_packed_width() > 0)
+                throw (std::runtime_error(oat::packed::sourceError(frame_sources[i]->get_name())));
             
             // Push newest frame into client N's queue
-            if (frame_write_buffers[i]->push(current_frame) == 0) {
+            auto sample = std::make_pair(frame_sources[i]->get_current_sample_number(), 
+                                         current_frame);
+
+            if (frame_write_buffers[i]->push(sample) == 0) {
 
                 throw (std::runtime_error(
                         "Frame buffer overrun. "
@@ -258,12 +309,24 @@ bool Recorder::writeStreams() {
         
         i = position_read_required.find_next(i);
     }
+
+    // Get current position arrays
+    i = array_read_required.find_first();
+    while (i < number_of_array_sources) {
+        
+        array_read_required[i] = 
+                !array_sources[i]->getSharedObject(*source_arrays[i]);
+        
+        i = array_read_required.find_next(i);
+    }
     
     // If we have not finished reading _any_ of the clients, we cannot proceed
-    if (frame_read_required.none() && position_read_required.none()) {
+    if (frame_read_required.none() && position_read_required.none() 
+            && array_read_required.none()) {
     
         // Reset the frame and position client read counter
         position_read_required.set();
+        array_read_required.set();
         frame_read_required.set();
 
         // Write the frames to file
@@ -275,21 +338,35 @@ bool Recorder::writeStreams() {
 
 void Recorder::writeFramesToFileFromBuffer(uint32_t writer_idx) {
 
-    cv::Mat m;
+    std::pair<uint32_t, cv::Mat> sample;
     while (running) {
 
         std::unique_lock<std::mutex> lk(*frame_write_mutexes[writer_idx]);
         frame_write_condition_variables[writer_idx]->wait_for(lk, std::chrono::milliseconds(10));
 
-        while (frame_write_buffers[writer_idx]->pop(m)) {
+        while (frame_write_buffers[writer_idx]->pop(sample)) {
+
+            if (raw_video) {
+
+                // Frames are dropped once writing a file has failed
+                auto &writer = raw_writers[writer_idx];
+                try {
+                    if (writer)
+                        writer->write(sample.first, sample.second);
+                } catch (const std::runtime_error& ex) {
+                    std::cerr << oat::whoError(name, ex.what()) << "\n";
+                    writer.reset();
+                }
+                continue;
+            }
 
             if (!video_writers[writer_idx]->isOpened()) {
                 initializeWriter(*video_writers[writer_idx],
                         video_file_names.at(writer_idx),
-                        m);
+                        sample.second);
             }
 
-            video_writers[writer_idx]->write(m);
+            video_writers[writer_idx]->write(sample.second);
         }
     }
 }
@@ -317,13 +394,31 @@ void Recorder::writePositionsToFile() {
             ++idx;
         }
 
+        idx = 0;
+        for (auto &arr : source_arrays) {
+
+            std::string sample_str = 
+                std::to_string(array_sources[idx]->get_current_time_stamp());
+            
+#ifdef RAPIDJSON_HAS_STDSTRING
+            json_writer.String(sample_str);
+#else
+            json_writer.String(sample_str.c_str(), 
+                    static_cast<rapidjson::SizeType>(sample_str.length()));
+#endif
+
+            arr->Serialize(json_writer);
+            ++idx;
+        }
+
         json_writer.EndObject();
     }
 }
 
 void Recorder::writePositionFileHeader(const std::string& date, 
         const double sample_rate, 
-        const std::vector<std::string>& sources) {
+        const std::vector<std::string>& sources,
+        const std::vector<std::string>& array_sources) {
     
     json_writer.StartObject();
     
@@ -339,6 +434,16 @@ void Recorder::writePositionFileHeader(const std::string& date,
         json_writer.String(s.c_str());
     }
     json_writer.EndArray();
+
+    if (!array_sources.empty()) {
+
+        json_writer.String("position_array_sources");
+        json_writer.StartArray();
+        for (auto &s : array_sources) {
+            json_writer.String(s.c_str());
+        }
+        json_writer.EndArray();
+    }
     
     json_writer.EndObject();
 
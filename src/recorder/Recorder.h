@@ -34,6 +34,9 @@
 #include "../../lib/shmem/MatClient.h"
 #include "../../lib/shmem/SMClient.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/Position2DArray.h"
+
+#include "RawFrameWriter.h"
 
 /**
  * Position and frame recorder.
@@ -44,20 +47,26 @@ public:
     /**
      * Position and frame recorder.
      * @param position_source_names Names specifying position SOURCES to record
+     * @param position_array_source_names Names specifying position array
+     * SOURCES to record
      * @param frame_source_names Names specifying frame SOURCES to record
      * @param save_path Directory to which files will be written
      * @param file_name Base file name
      * @param append_date Should the date be prepended to the file name
      * @param frames_per_second Frame rate if video is recorded
      * @param overwrite Should a file with the same name be overwritten
+     * @param raw_video Write frames uncompressed to raw frame files instead
+     * of encoding them
      */
     Recorder(const std::vector<std::string>& position_source_names,
+            const std::vector<std::string>& position_array_source_names,
             const std::vector<std::string>& frame_source_names,
             std::string save_path = ".",
             std::string file_name = "",
             const bool prepend_date = false,
             const int frames_per_second = 30,
-            const bool overwrite = false);
+            const bool overwrite = false,
+            const bool raw_video = false);
 
     ~Recorder();
     
@@ -90,9 +99,12 @@ private:
     
     // Video files
     const int frames_per_second;
+    const bool raw_video;
     std::vector< std::string > video_file_names;
     std::vector< std::unique_ptr
                < cv::VideoWriter > > video_writers;
+    std::vector< std::unique_ptr
+               < RawFrameWriter > > raw_writers;
     
     // Position file
     FILE* position_fp;
@@ -117,7 +129,7 @@ private:
                < std::condition_variable > > frame_write_condition_variables;
     std::vector< std::unique_ptr
                < boost::lockfree::spsc_queue
-               < cv::Mat, boost::lockfree::capacity
+               < std::pair<uint32_t, cv::Mat>, boost::lockfree::capacity
                < FRAME_WRITE_BUFFER_SIZE > > > > frame_write_buffers;
     
     // Position sources
@@ -128,6 +140,15 @@ private:
     std::vector< std::unique_ptr
                < oat::Position2D > > source_positions;
     boost::dynamic_bitset<> position_read_required;
+
+    // Position array sources
+    boost::dynamic_bitset<>::size_type number_of_array_sources;
+    std::vector< std::unique_ptr
+               < oat::SMClient
+               < oat::Position2DArray > > > array_sources;
+    std::vector< std::unique_ptr
+               < oat::Position2DArray > > source_arrays;
+    boost::dynamic_bitset<> array_read_required;
     
     // SOURCES EOF flag
     bool sources_eof;
@@ -147,7 +168,8 @@ private:
     void writePositionFileHeader(
         const std::string& date, 
         const double sample_rate, 
-        const std::vector<std::string>& sources);
+        const std::vector<std::string>& sources,
+        const std::vector<std::string>& array_sources);
 };
 
 #endif // RECORDER_H
@@ -59,9 +59,11 @@ int main(int argc, char *argv[]) {
 
     std::vector<std::string> frame_sources;
     std::vector<std::string> position_sources;
+    std::vector<std::string> position_array_sources;
     std::string file_name;
     std::string save_path;
     bool allow_overwrite = false;
+    bool raw_video = false;
     
     int fps;
     bool append_date = false;
@@ -87,11 +89,18 @@ int main(int argc, char *argv[]) {
                 "a numerical index being added to the file path.")
                 ("position-sources,p", po::value< std::vector<std::string> >()->multitoken(),
                 "The names of the POSITION SOURCES that supply object positions to be recorded.")
+                ("position-array-sources,a", po::value< std::vector<std::string> >()->multitoken(),
+                "The names of the POSITION SOURCES that supply arrays of object positions "
+                "(e.g. posidet hsv with max_objects > 0) to be recorded.")
                 ("image-sources,i", po::value< std::vector<std::string> >()->multitoken(),
                 "The names of the FRAME SOURCES that supply images to save to video.")
                 ("frames-per-second,F", po::value<int>(&fps),
                 "The frame rate of the recorded video. This determines playback speed of the recording. "
                 "It does not affect online processing in any way.\n")
+                ("raw,r",
+                "If set, frames are written uncompressed, along with their sample numbers, "
+                "to raw frame files (*.raw) that can be served using frameserve TYPE=raw. "
+                "Otherwise, frames are encoded to video files.")
                 ;
 
         po::options_description all_options("OPTIONS");
@@ -121,7 +130,9 @@ int main(int argc, char *argv[]) {
             return 0;
         }
 
-        if (!variable_map.count("position-sources") && !variable_map.count("image-sources")) {
+        if (!variable_map.count("position-sources") && 
+                !variable_map.count("position-array-sources") &&
+                !variable_map.count("image-sources")) {
             printUsage(all_options);
             std::cerr << oat::Error("At least a single POSITION SOURCE or FRAME SOURCE must be specified.\n");
             return -1;
@@ -155,6 +166,17 @@ int main(int argc, char *argv[]) {
             }
         }
         
+        if (variable_map.count("position-array-sources")) {
+            position_array_sources = variable_map["position-array-sources"].as< std::vector<std::string> >();
+            
+            std::vector<std::string>::iterator it;
+            it = std::unique (position_array_sources.begin(), position_array_sources.end());   
+            if (it != position_array_sources.end()) {
+                position_array_sources.resize(std::distance(position_array_sources.begin(),it)); 
+                std::cerr << oat::Warn("Warning: duplicate position array sources have been removed.\n");
+            }
+        }
+        
         if (variable_map.count("image-sources")) {
             frame_sources = variable_map["image-sources"].as< std::vector<std::string> >();
             
@@ -175,6 +197,10 @@ int main(int argc, char *argv[]) {
             allow_overwrite = true;
         } 
 
+        if (variable_map.count("raw")) {
+            raw_video = true;
+        } 
+
 
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
@@ -185,7 +211,9 @@ int main(int argc, char *argv[]) {
     }
 
     // Create component
-    Recorder recorder(position_sources, frame_sources, save_path, file_name, append_date, fps, allow_overwrite);
+    Recorder recorder(position_sources, position_array_sources, frame_sources, 
+                      save_path, file_name, 
+                      append_date, fps, allow_overwrite, raw_video);
 
     // Tell user
     if (!frame_sources.empty()) {
@@ -209,6 +237,17 @@ int main(int argc, char *argv[]) {
 
         std::cout << ".\n";
     }
+
+    if (!position_array_sources.empty()) {
+
+        std::cout << oat::whoMessage(recorder.get_name(),
+                "Listening to position array sources ");
+
+        for (auto s : position_array_sources)
+            std::cout << oat::sourceText(s) << " ";
+
+        std::cout << ".\n";
+    }
     
     std::cout << oat::whoMessage(recorder.get_name(), 
                  "Press CTRL+C to exit.\n");